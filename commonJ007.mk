@@ -14,4 +14,6 @@ PRODUCT_PACKAGES += $(J007_ENGINE)
 # Add J007EngineTest hidl & J007ServiceTest for debug building
 PRODUCT_PACKAGES_DEBUG += \
     com.journeyOS.J007engine.hidl.test \
+    com.journeyOS.J007engine.hidl.scene_benchmark \
+    com.journeyOS.J007engine.json.benchmark \
     J007ServiceTest
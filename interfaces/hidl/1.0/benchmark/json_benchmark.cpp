@@ -0,0 +1,937 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "json/json_document.h"
+#include "json/json_object.h"
+#include "json/json_tape_view.h"
+#include "global_scene.h"
+#include "factors.h"
+
+extern "C" {
+#include "json/json_scan.h"
+#include "json/json_arena.h"
+#include "json/json_atom.h"
+#include "json/json_reader.h"
+#include "json/json_binary.h"
+#include "json/json_tape.h"
+}
+
+#define DEFAULT_CPUSET_FILE     "/vendor/etc/j007_engine/cpuset.json"
+#define DEFAULT_ITERATIONS      20000
+
+using namespace std;
+
+// results the compiler must not drop
+static volatile int sink;
+
+// allocations through Json_malloc (installed with Json_InitHooks) and operator new, for allocs/op;
+// the arena blocks, the scanner's index and the reader buffer come from malloc directly and are not counted
+static size_t allocations;
+
+static void *countingMalloc(size_t size) {
+    ++allocations;
+    return malloc(size);
+}
+
+void *operator new(size_t size) {
+    ++allocations;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+struct Corpus {
+    string name;
+    string text;
+};
+
+// What NotifyManager sends for SCENE_FACTOR_APP / SCENE_FACTOR_BATTERY (gson, SceneState)
+static const char *SCENE_APP =
+        "{\"battery\":{\"level\":85,\"pluggedIn\":0,\"status\":3,\"health\":2,\"temperature\":312},"
+        "\"app\":{\"packageName\":\"com.tencent.mm\",\"type\":\"im\",\"mode\":-1,\"fps\":-1,\"cpu\":-1,"
+        "\"memc\":-1,\"bl\":0},\"brightness\":128}";
+
+static const char *SCENE_BATTERY =
+        "{\"battery\":{\"level\":42,\"pluggedIn\":2,\"status\":2,\"health\":2,\"temperature\":367},"
+        "\"brightness\":-1}";
+
+// SCENE_APP again, only the members that changed: a merge patch (RFC 7386)
+static const char *SCENE_APP_DELTA = "{\"app\":{\"mode\":1,\"fps\":90}}";
+
+static string readFile(const char *path) {
+    string text;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return text;
+    }
+
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        text.append(buf, n);
+    }
+    fclose(f);
+
+    return text;
+}
+
+static void report(const char *label, const Corpus &corpus, double ns, double allocs) {
+    double mbs = corpus.text.size() / ns * 1e9 / (1024 * 1024);
+    printf("%-20s %-22s %10.1f ns/op %9.1f MB/s %8.1f allocs/op\n", corpus.name.c_str(), label, ns, mbs, allocs);
+}
+
+template<typename Fn>
+static void bench(const char *label, const Corpus &corpus, int iterations, Fn fn) {
+    // warm up caches and the allocator
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        fn(corpus.text);
+    }
+
+    size_t before = allocations;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn(corpus.text);
+    }
+    auto end = chrono::steady_clock::now();
+
+    report(label, corpus, chrono::duration<double, nano>(end - start).count() / iterations,
+           (double) (allocations - before) / iterations);
+}
+
+static void benchParse(const Corpus &corpus, int iterations) {
+    bench("parse/descent", corpus, iterations, [](const string &text) {
+        Json_Delete(Json_ParseDescent(text.c_str()));
+    });
+
+    bench("parse/indexed", corpus, iterations, [](const string &text) {
+        Json_Delete(Json_Parse(text.c_str()));
+    });
+
+    bench("scan/index-only", corpus, iterations, [](const string &text) {
+        Json_Index index;
+        Json_BuildIndex(text.c_str(), text.size(), &index);
+        Json_FreeIndex(&index);
+    });
+
+    Json_Arena *arena = Json_ArenaCreate(0);
+    bench("parse/arena", corpus, iterations, [arena](const string &text) {
+        Json_ParseInArena(text.c_str(), arena);
+        Json_ArenaReset(arena);
+    });
+
+    // in situ needs a writable copy, as updateScene has one; the copy is part of the cost
+    string buffer;
+    bench("parse/insitu", corpus, iterations, [&buffer](const string &text) {
+        buffer.assign(text);
+        Json_Delete(Json_ParseInSitu(&buffer[0]));
+    });
+
+    bench("parse/insitu+arena", corpus, iterations, [&buffer, arena](const string &text) {
+        buffer.assign(text);
+        Json_ParseInSituInArena(&buffer[0], arena);
+        Json_ArenaReset(arena);
+    });
+
+    Json_ArenaStats stats;
+    Json_ParseInArena(corpus.text.c_str(), arena);
+    Json_ArenaGetStats(arena, &stats);
+    printf("%-20s %-22s %10zu bytes %6zu allocs, %zu block(s) of %zu bytes after warm up\n",
+           corpus.name.c_str(), "arena/document", stats.used, stats.allocations, stats.blocks, stats.reserved);
+    Json_ArenaDestroy(arena);
+}
+
+// Json_Print/Json_PrintUnformatted grow one buffer from JSON_PRINT_DEFAULT_BUFFER,
+// print/estimated sizes it with a walk of the tree first
+static void benchPrint(const Corpus &corpus, int iterations) {
+    Json *doc = Json_Parse(corpus.text.c_str());
+    JsonObject oJson(corpus.text);
+
+    bench("print/unformatted", corpus, iterations, [doc](const string &) {
+        char *text = Json_PrintUnformatted(doc);
+        sink = text[0];
+        free(text);
+    });
+
+    bench("print/formatted", corpus, iterations, [doc](const string &) {
+        char *text = Json_Print(doc);
+        sink = text[0];
+        free(text);
+    });
+
+    bench("print/estimated", corpus, iterations, [doc](const string &) {
+        char *text = Json_PrintBuffered(doc, 0, 0);
+        sink = text[0];
+        free(text);
+    });
+
+    bench("print/tostring", corpus, iterations, [&oJson](const string &) {
+        sink = (int) oJson.ToString().size();
+    });
+
+    Json_Delete(doc);
+}
+
+// Json_Delete and JsonObject::Clear on their own: the trees are parsed a batch at a time, off the clock
+static void benchTeardown(const Corpus &corpus, int iterations) {
+    const int batch = 64;
+    vector<Json *> docs(batch);
+    double ns = 0;
+    int done = 0;
+    for (; done < iterations; done += batch) {
+        for (auto &&doc : docs) {
+            doc = Json_Parse(corpus.text.c_str());
+        }
+
+        auto start = chrono::steady_clock::now();
+        for (auto &&doc : docs) {
+            Json_Delete(doc);
+        }
+        ns += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    }
+    report("teardown/delete", corpus, ns / done, 0);
+
+    vector<JsonObject> objects(batch);
+    ns = 0;
+    for (done = 0; done < iterations; done += batch) {
+        for (auto &&oJson : objects) {
+            oJson.Parse(corpus.text);
+        }
+
+        auto start = chrono::steady_clock::now();
+        for (auto &&oJson : objects) {
+            oJson.Clear();
+        }
+        ns += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    }
+    report("teardown/jsonobject", corpus, ns / done, 0);
+}
+
+// What JsonObject copies and operator== used to cost, against the tree walks they use now
+static void benchCopy(const Corpus &corpus, int iterations) {
+    Json *doc = Json_Parse(corpus.text.c_str());
+    Json *other = Json_Parse(corpus.text.c_str());
+
+    bench("copy/print+parse", corpus, iterations, [doc](const string &) {
+        char *text = Json_PrintUnformatted(doc);
+        Json_Delete(Json_Parse(text));
+        free(text);
+    });
+
+    bench("copy/duplicate", corpus, iterations, [doc](const string &) {
+        Json_Delete(Json_Duplicate(doc, 1));
+    });
+
+    // what a reader on another thread gets: a private JsonObject, or one more owner of a frozen tree
+    JsonObject oJson(corpus.text);
+    bench("copy/jsonobject", corpus, iterations, [&oJson](const string &) {
+        JsonObject oCopy(oJson);
+        sink = oCopy.IsEmpty();
+    });
+
+    JsonDocument oDocument(corpus.text);
+    bench("copy/document", corpus, iterations, [&oDocument](const string &) {
+        JsonDocument oCopy(oDocument);
+        sink = oCopy.IsEmpty();
+    });
+
+    bench("equal/print+strcmp", corpus, iterations, [doc, other](const string &) {
+        char *a = Json_PrintUnformatted(doc);
+        char *b = Json_PrintUnformatted(other);
+        sink = strcmp(a, b);
+        free(a);
+        free(b);
+    });
+
+    bench("equal/compare", corpus, iterations, [doc, other](const string &) {
+        sink = Json_Compare(doc, other);
+    });
+
+    Json_Delete(doc);
+    Json_Delete(other);
+}
+
+// Everything a reader of the document touches, summed: the walk of a tree and of a tape of it
+static size_t walkTree(const Json *item) {
+    size_t total = item->type;
+    if (item->type == Json_String) {
+        total += strlen(item->valuestring);
+    } else if (item->type == Json_Int || item->type == Json_Double) {
+        total += (size_t) item->valueint;
+    }
+
+    for (const Json *child = item->child; child != NULL; child = child->next) {
+        total += walkTree(child) + (child->string != NULL ? strlen(child->string) : 0);
+    }
+
+    return total;
+}
+
+// The tape read the way it is laid out: the type, then only what that type holds, strings and
+// keys with their lengths
+static size_t walkTape(const Json_Tape *tape, size_t at) {
+    int type = Json_TapeType(tape, at);
+    size_t total = type;
+    uint32 len;
+    if (type == Json_String) {
+        Json_TapeString(tape, at, &len);
+        total += len;
+    } else if (type == Json_Int || type == Json_Double) {
+        total += (size_t) Json_TapeGetInt(tape, at);
+    }
+
+    bool object = type == Json_Object;
+    for (size_t c = Json_TapeChild(tape, at); c != JSON_TAPE_NONE; c = Json_TapeNext(tape, at, c)) {
+        total += walkTape(tape, c);
+        if (object) {
+            Json_TapeString(tape, c - 1, &len);
+            total += len;
+        }
+    }
+
+    return total;
+}
+
+// What the nodes of a tree take: the node itself, its key and its string, without allocator overhead
+static size_t treeBytes(const Json *item, size_t *nodes) {
+    size_t bytes = sizeof(Json) + (item->string != NULL ? strlen(item->string) + 1 : 0);
+    if (item->type == Json_String) {
+        bytes += strlen(item->valuestring) + 1;
+    }
+
+    ++*nodes;
+    for (const Json *child = item->child; child != NULL; child = child->next) {
+        bytes += treeBytes(child, nodes);
+    }
+
+    return bytes;
+}
+
+// The linked tree against the flat tape (json_tape.h): building, walking and what each keeps in memory
+static void benchTape(const Corpus &corpus, int iterations) {
+    Json *doc = Json_Parse(corpus.text.c_str());
+    Json_Tape *tape = Json_TapeParse(corpus.text.c_str(), corpus.text.size());
+    if (doc == NULL || tape == NULL) {
+        Json_Delete(doc);
+        Json_TapeDelete(tape);
+        return;
+    }
+
+    size_t nodes = 0, bytes = treeBytes(doc, &nodes);
+    Json_TapeStats stats;
+    Json_TapeGetStats(tape, &stats);
+    size_t tapeBytes = stats.entries * sizeof(uint64) + stats.string_bytes;
+    printf("%-20s %-22s %10zu bytes %9.1f bytes/node\n", corpus.name.c_str(), "memory/tree", bytes,
+           (double) bytes / nodes);
+    printf("%-20s %-22s %10zu bytes %9.1f bytes/node\n", corpus.name.c_str(), "memory/tape", tapeBytes,
+           (double) tapeBytes / stats.values);
+
+    bench("parse/tape", corpus, iterations, [](const string &text) {
+        Json_TapeDelete(Json_TapeParse(text.c_str(), text.size()));
+    });
+
+    bench("walk/tree", corpus, iterations, [doc](const string &) {
+        sink = (int) walkTree(doc);
+    });
+
+    bench("walk/tape", corpus, iterations, [tape](const string &) {
+        sink = (int) walkTape(tape, 0);
+    });
+
+    Json_Delete(doc);
+    Json_TapeDelete(tape);
+}
+
+// [312,367,...] and [0.85,36.7,...]: battery temperatures and levels, the numbers the scenes carry, n of them
+static string numberArray(int n, bool fraction) {
+    string text = "[";
+    unsigned seed = 1;
+    for (int i = 0; i < n; ++i) {
+        char entry[32];
+        seed = seed * 1103515245 + 12345;
+        if (fraction) {
+            snprintf(entry, sizeof(entry), "%s%.*g", i ? "," : "", 1 + (int) (seed >> 16) % 15,
+                     (double) (seed >> 8) / (1 + (seed & 0xffff)));
+        } else {
+            snprintf(entry, sizeof(entry), "%s%d", i ? "," : "", (int) (seed >> 8) - (1 << 22));
+        }
+        text += entry;
+    }
+    text += "]";
+
+    return text;
+}
+
+// Numbers through parse_number/print_number, against strtod and %.17g on the same text.
+// The parse is in an arena so that node allocation doesn't hide the conversion.
+static void benchNumbers(int iterations) {
+    const Corpus corpora[] = {{"numbers/int", numberArray(1024, false)},
+                              {"numbers/double", numberArray(1024, true)}};
+    Json_Arena *arena = Json_ArenaCreate(0);
+    for (auto &&corpus : corpora) {
+        int loops = iterations / 100 + 1;
+
+        bench("number/strtod", corpus, loops, [](const string &text) {
+            double total = 0;
+            for (const char *p = text.c_str() + 1; *p; ++p) {
+                char *end;
+                total += strtod(p, &end);
+                p = end;
+            }
+            sink = (int) total;
+        });
+
+        bench("number/parse", corpus, loops, [arena](const string &text) {
+            Json_ParseInArena(text.c_str(), arena);
+            Json_ArenaReset(arena);
+        });
+
+        Json *doc = Json_Parse(corpus.text.c_str());
+        bench("number/printf", corpus, loops, [doc](const string &) {
+            char number[32];
+            size_t total = 0;
+            for (Json *item = doc->child; item; item = item->next) {
+                total += snprintf(number, sizeof(number), "%.17g", item->valuedouble);
+            }
+            sink = (int) total;
+        });
+
+        bench("number/print", corpus, loops, [doc](const string &) {
+            char *text = Json_PrintUnformatted(doc);
+            sink = text[0];
+            free(text);
+        });
+        Json_Delete(doc);
+    }
+    Json_ArenaDestroy(arena);
+}
+
+// {"com.example.app0":"game","com.example.app1":"im",...}, the shape of the app classification db
+static string appTypeDb(int apps) {
+    static const char *types[] = {"default", "album", "im", "music", "game", "video", "news", "launcher"};
+    string text = "{";
+    for (int i = 0; i < apps; ++i) {
+        char entry[96];
+        snprintf(entry, sizeof(entry), "%s\"com.example.app%d\":\"%s\"", i ? "," : "", i, types[i % 8]);
+        text += entry;
+    }
+    text += "}";
+
+    return text;
+}
+
+static void benchLookup(int iterations) {
+    const int sizes[] = {8, 64, 512, 4096};
+    for (int apps : sizes) {
+        Corpus corpus = {"db/" + to_string(apps) + "-apps", appTypeDb(apps)};
+        Json *db = Json_Parse(corpus.text.c_str());
+        vector<string> keys;
+        for (int i = 0; i < apps; ++i) {
+            keys.push_back("com.example.app" + to_string((i * 7919) % apps));
+        }
+
+        int lookups = iterations * 8 / apps + 1;
+        bench("lookup/all-keys", corpus, lookups, [db, &keys](const string &) {
+            for (auto &&key : keys) {
+                Json_GetObjectItem(db, key.c_str());
+            }
+        });
+        bench("lookup/case-sensitive", corpus, lookups, [db, &keys](const string &) {
+            for (auto &&key : keys) {
+                Json_GetObjectItemCaseSensitive(db, key.c_str());
+            }
+        });
+        Json_Delete(db);
+
+        // every key with its value, the db parsed each time: the key list GetKey copies on its first
+        // call, and a lookup per key, against one walk of the members
+        bench("keys/getkey", corpus, lookups, [](const string &text) {
+            JsonObject oDb(text);
+            string key;
+            size_t total = 0;
+            while (oDb.GetKey(key)) {
+                total += key.size() + oDb(key).size();
+            }
+            sink = (int) total;
+        });
+
+        bench("keys/members", corpus, lookups, [](const string &text) {
+            JsonObject oDb(text);
+            size_t total = 0;
+            for (const JsonView::Member &oMember : oDb.Members()) {
+                total += strlen(oMember.szKey) + JsonView::ToValueString(oMember.oValue.GetJson()).size();
+            }
+            sink = (int) total;
+        });
+    }
+}
+
+// The app scene before and after its keys are interned, as GlobalScene interns them: parsed keys
+// take the atoms instead of a copy each, lookups through atoms compare pointers. Run before
+// anything decodes an App from a tree, which interns its fields too.
+static void benchAtoms(int iterations) {
+    Corpus corpus = {"scene/app", SCENE_APP};
+    const char *fields[] = {"packageName", "type", "mode", "fps", "cpu", "memc"};
+    Json *doc = Json_Parse(corpus.text.c_str());
+    bench("lookup/strings", corpus, iterations, [doc, &fields](const string &) {
+        Json *app = Json_GetObjectItem(doc, "app");
+        for (const char *field : fields) {
+            sink = Json_GetObjectItem(app, field) != NULL;
+        }
+    });
+    Json_Delete(doc);
+
+    JsonBinding::Intern<App>();
+    const char *appKey = Json_Intern("app");
+    const char *atoms[6];
+    for (int i = 0; i < 6; ++i) {
+        atoms[i] = Json_Intern(fields[i]);
+    }
+
+    // parse/indexed and parse/arena of benchParse, now with atoms
+    bench("parse/indexed+atoms", corpus, iterations, [](const string &text) {
+        Json_Delete(Json_Parse(text.c_str()));
+    });
+
+    Json_Arena *arena = Json_ArenaCreate(0);
+    bench("parse/arena+atoms", corpus, iterations, [arena](const string &text) {
+        Json_ParseInArena(text.c_str(), arena);
+        Json_ArenaReset(arena);
+    });
+
+    doc = Json_Parse(corpus.text.c_str());
+    bench("lookup/atoms", corpus, iterations, [doc, appKey, &atoms](const string &) {
+        Json *app = Json_GetObjectItemByAtom(doc, appKey, 0);
+        for (const char *atom : atoms) {
+            sink = Json_GetObjectItemByAtom(app, atom, 0) != NULL;
+        }
+    });
+    Json_Delete(doc);
+    Json_ArenaDestroy(arena);
+}
+
+// GlobalScene::parseScene for SCENE_FACTOR_APP, through JsonObject wrappers, through JsonView and
+// through the App schema, and App back to text
+static void benchScene(int iterations) {
+    Corpus corpus = {"scene/app", SCENE_APP};
+    Json_Arena *arena = Json_ArenaCreate(0);
+    string buffer;
+    string packageName, type;
+    int mode, fps, cpu, memc;
+
+    bench("update/jsonobject", corpus, iterations, [&](const string &text) {
+        buffer.assign(text);
+        JsonObject oJson;
+        oJson.ParseInSitu(buffer, arena);
+        oJson["app"].Get("packageName", packageName);
+        oJson["app"].Get("type", type);
+        oJson["app"].Get("mode", mode);
+        oJson["app"].Get("fps", fps);
+        oJson["app"].Get("cpu", cpu);
+        oJson["app"].Get("memc", memc);
+        oJson.Clear();
+        Json_ArenaReset(arena);
+    });
+
+    bench("update/jsonview", corpus, iterations, [&](const string &text) {
+        buffer.assign(text);
+        JsonObject oJson;
+        oJson.ParseInSitu(buffer, arena);
+        JsonView oApp = oJson.View()["app"];
+        oApp.Get("packageName", packageName);
+        oApp.Get("type", type);
+        oApp.Get("mode", mode);
+        oApp.Get("fps", fps);
+        oApp.Get("cpu", cpu);
+        oApp.Get("memc", memc);
+        oJson.Clear();
+        Json_ArenaReset(arena);
+    });
+
+    // the six fields in one walk, the pointers compiled once
+    const char *fields[] = {"/app/packageName", "/app/type", "/app/mode", "/app/fps", "/app/cpu", "/app/memc"};
+    Json_Path *path = Json_PathCompileSet(fields, 6, 0);
+    bench("update/path", corpus, iterations, [&](const string &text) {
+        buffer.assign(text);
+        Json *items[6];
+        Json *doc = Json_ParseInSituInArena(&buffer[0], arena);
+        Json_PathFindEach(path, doc, items);
+        JsonView::ToValue(items[0], packageName);
+        JsonView::ToValue(items[1], type);
+        JsonView::ToValue(items[2], mode);
+        JsonView::ToValue(items[3], fps);
+        JsonView::ToValue(items[4], cpu);
+        JsonView::ToValue(items[5], memc);
+        Json_ArenaReset(arena);
+    });
+    Json_PathDelete(path);
+
+    Json_Reader *reader = Json_ReaderCreate(0);
+    App app;
+    bench("update/binding", corpus, iterations, [&](const string &text) {
+        Json_ReaderSetText(reader, text.c_str(), text.size());
+        JsonBinding::DecodeMember(reader, "app", app);
+    });
+    Json_ReaderDestroy(reader);
+
+    // GlobalScene::parseScene: the status merged into a kept scene, App decoded from the tree
+    const char *appKey = Json_Intern("app");
+    Json *scene = Json_Parse(SCENE_APP);
+    bench("update/merge", corpus, iterations, [&](const string &text) {
+        Json *patch = Json_ParseInArena(text.c_str(), arena);
+        Json_MergePatch(scene, patch, 0);
+        Json_Delete(patch);
+        Json_ArenaReset(arena);
+        JsonBinding::Decode(Json_GetObjectItemByAtom(scene, appKey, 0), app);
+    });
+
+    // what parseScene does now: the member of the factor built and merged, the others only skipped
+    bench("update/merge-lazy", corpus, iterations, [&](const string &text) {
+        Json *patch = Json_ParseMembersInArena(text.c_str(), &appKey, 1, arena);
+        Json_MergePatch(scene, patch, 0);
+        Json_Delete(patch);
+        Json_ArenaReset(arena);
+        JsonBinding::Decode(Json_GetObjectItemByAtom(scene, appKey, 0), app);
+    });
+
+    // a battery update carrying the whole scene: the app member is never built
+    const char *batteryKey = Json_Intern("battery");
+    Battery battery;
+    bench("battery/merge", corpus, iterations, [&](const string &text) {
+        Json *patch = Json_ParseInArena(text.c_str(), arena);
+        Json_MergePatch(scene, patch, 0);
+        Json_Delete(patch);
+        Json_ArenaReset(arena);
+        JsonBinding::Decode(Json_GetObjectItemByAtom(scene, batteryKey, 0), battery);
+    });
+
+    bench("battery/merge-lazy", corpus, iterations, [&](const string &text) {
+        Json *patch = Json_ParseMembersInArena(text.c_str(), &batteryKey, 1, arena);
+        Json_MergePatch(scene, patch, 0);
+        Json_Delete(patch);
+        Json_ArenaReset(arena);
+        JsonBinding::Decode(Json_GetObjectItemByAtom(scene, batteryKey, 0), battery);
+    });
+
+    Corpus delta = {"scene/app-delta", SCENE_APP_DELTA};
+    bench("update/merge", delta, iterations, [&](const string &text) {
+        Json *patch = Json_ParseInArena(text.c_str(), arena);
+        Json_MergePatch(scene, patch, 0);
+        Json_Delete(patch);
+        Json_ArenaReset(arena);
+        JsonBinding::Decode(Json_GetObjectItemByAtom(scene, appKey, 0), app);
+    });
+
+    // the sender's side: the delta from the last scene sent to the current one
+    Json *last = Json_Parse(SCENE_APP);
+    bench("update/merge-diff", corpus, iterations, [&](const string &) {
+        Json *patch = Json_MergeDiff(last, scene);
+        sink = patch->child != NULL;
+        Json_Delete(patch);
+    });
+    Json_Delete(last);
+    Json_Delete(scene);
+
+    // the engine's GlobalScene, as notifySceneChanged (1.0) and notifyAppSwitch (1.1) call it:
+    // the status parsed, merged, decoded and published, against the App copied and published.
+    // The calls take turns with two scenes, a status GlobalScene got just before is dropped unparsed
+    GlobalScene *global = GlobalScene::getInstance();
+    string statuses[2] = {SCENE_APP, SCENE_APP};
+    App typed[2] = {app, app};
+    for (int i = 0; i < 2; i++) {
+        typed[i].packageName = "com.tencent.mm";
+        typed[i].fps = i == 0 ? 60 : 90;
+        statuses[i].replace(statuses[i].find("\"fps\":-1"), strlen("\"fps\":-1"),
+                            "\"fps\":" + to_string(typed[i].fps));
+    }
+
+    int turn = 0;
+    bench("update/scene", corpus, iterations, [&](const string &) {
+        sink = !global->updateScene(SCENE_FACTOR_APP, statuses[turn++ & 1], typed[0].packageName).isEmpty();
+    });
+
+    bench("update/typed", corpus, iterations, [&](const string &) {
+        sink = !global->updateApp(typed[turn++ & 1]).isEmpty();
+    });
+
+    bench("encode/jsonobject", corpus, iterations, [&](const string &) {
+        JsonObject oApp;
+        oApp.Add("packageName", app.packageName);
+        oApp.Add("type", app.type);
+        oApp.Add("mode", app.mode);
+        oApp.Add("fps", app.fps);
+        oApp.Add("cpu", app.cpu);
+        oApp.Add("memc", app.memc);
+        sink = (int) oApp.ToString().size();
+    });
+
+    bench("encode/binding", corpus, iterations, [&](const string &) {
+        sink = (int) JsonBinding::Encode(app).size();
+    });
+
+    Json_ArenaDestroy(arena);
+}
+
+// Text against Json_Binary for the app and battery scenes: the whole scene through the tree both
+// ways, and the member GlobalScene wants decoded straight into its struct
+template<class T>
+static void benchBinaryScene(const char *name, const char *text, const char *szMember, int iterations) {
+    Json *doc = Json_Parse(text);
+    size_t len = 0;
+    char *binary = Json_PrintBinary(doc, &len);
+    Corpus corpus = {name, text};
+    Corpus binaryCorpus = {string(name) + "/binary", string(binary, len)};
+    free(binary);
+    printf("%-20s %-22s %10zu bytes text, %zu bytes binary\n", name, "size", corpus.text.size(), len);
+
+    bench("tree/parse", corpus, iterations, [](const string &text) {
+        Json_Delete(Json_Parse(text.c_str()));
+    });
+
+    bench("tree/parse", binaryCorpus, iterations, [](const string &text) {
+        Json_Delete(Json_ParseBinary(text.data(), text.size()));
+    });
+
+    bench("tree/print", corpus, iterations, [doc](const string &) {
+        char *out = Json_PrintUnformatted(doc);
+        sink = out[0];
+        free(out);
+    });
+
+    bench("tree/print", binaryCorpus, iterations, [doc](const string &) {
+        size_t size;
+        char *out = Json_PrintBinary(doc, &size);
+        sink = out[0];
+        free(out);
+    });
+
+    Json_Reader *reader = Json_ReaderCreate(0);
+    T value = T();
+    bench("struct/decode", corpus, iterations, [&](const string &text) {
+        Json_ReaderSetText(reader, text.data(), text.size());
+        JsonBinding::DecodeMember(reader, szMember, value);
+    });
+
+    bench("struct/decode", binaryCorpus, iterations, [&](const string &text) {
+        Json_ReaderSetText(reader, text.data(), text.size());
+        JsonBinding::DecodeMember(reader, szMember, value);
+    });
+    Json_ReaderDestroy(reader);
+
+    string out;
+    bench("struct/encode", corpus, iterations, [&](const string &) {
+        out.clear();
+        JsonBinding::Encode(value, out);
+        sink = (int) out.size();
+    });
+
+    bench("struct/encode", binaryCorpus, iterations, [&](const string &) {
+        out.clear();
+        JsonBinding::EncodeBinary(value, out);
+        sink = (int) out.size();
+    });
+
+    Json_Delete(doc);
+}
+
+static void benchBinary(int iterations) {
+    benchBinaryScene<App>("scene/app", SCENE_APP, "app", iterations);
+    benchBinaryScene<Battery>("scene/battery", SCENE_BATTERY, "battery", iterations);
+}
+
+// {"cpuset":[{"name":"set0","config":[{"cpu":"...","value":"0-2"},...]},...]}, cpuset.json grown to a per-package policy
+static string cpusetPolicy(int sets, int configs) {
+    string text = "{\"cpuset\":[";
+    for (int i = 0; i < sets; ++i) {
+        text += string(i ? "," : "") + "{\"name\":\"set" + to_string(i) + "\",\"config\":[";
+        for (int j = 0; j < configs; ++j) {
+            text += string(j ? "," : "") + "{\"cpu\":\"/dev/cpuset/group" + to_string(j) + "/cpus\",\"value\":\"0-2\"}";
+        }
+        text += "]}";
+    }
+    text += "]}";
+
+    return text;
+}
+
+// The ways CpuPolicyAgent::loadConfig has walked the document
+static void benchArray(int iterations) {
+    const int sizes[] = {4, 32, 256};
+    for (int sets : sizes) {
+        Corpus corpus = {"policy/" + to_string(sets) + "x" + to_string(sets), cpusetPolicy(sets, sets)};
+        int loads = iterations / (sets * sets) + 1;
+
+        bench("load/by-position", corpus, loads, [](const string &text) {
+            JsonObject oJson(text);
+            size_t total = 0;
+            for (int i = 0; i < oJson["cpuset"].GetArraySize(); ++i) {
+                for (int j = 0; j < oJson["cpuset"][i]["config"].GetArraySize(); ++j) {
+                    total += oJson["cpuset"][i]["config"][j]("cpu").size();
+                }
+            }
+        });
+
+        bench("load/iterator", corpus, loads, [](const string &text) {
+            JsonObject oJson(text);
+            size_t total = 0;
+            for (JsonObject &oCpuset : oJson["cpuset"]) {
+                for (JsonObject &oConfig : oCpuset["config"]) {
+                    total += oConfig("cpu").size();
+                }
+            }
+        });
+
+        bench("load/view", corpus, loads, [](const string &text) {
+            JsonObject oJson(text);
+            size_t total = 0;
+            for (JsonView oCpuset : oJson.View()["cpuset"]) {
+                for (JsonView oConfig : oCpuset["config"]) {
+                    total += oConfig("cpu").size();
+                }
+            }
+        });
+
+        bench("load/foreach", corpus, loads, [](const string &text) {
+            JsonObject oJson(text);
+            size_t total = 0;
+            oJson.View()["cpuset"].ForEach([&total](JsonView oCpuset) {
+                oCpuset["config"].ForEach([&total](JsonView oConfig) {
+                    total += oConfig("cpu").size();
+                });
+            });
+            sink = (int) total;
+        });
+
+        Json_Path *path = Json_PathCompile("/cpuset/*/config/*/cpu", 0);
+        bench("load/tape", corpus, loads, [](const string &text) {
+            JsonTape oTape(text);
+            size_t total = 0;
+            for (JsonTapeView oCpuset : oTape.View()["cpuset"]) {
+                for (JsonTapeView oConfig : oCpuset["config"]) {
+                    total += oConfig("cpu").size();
+                }
+            }
+            sink = (int) total;
+        });
+
+        bench("load/path", corpus, loads, [path](const string &text) {
+            JsonObject oJson(text);
+            size_t total = 0;
+            Json_PathSelect(path, oJson.View().GetJson(), [](void *context, int, Json *item) {
+                *(size_t *) context += strlen(item->valuestring);
+                return (1);
+            }, &total);
+            sink = (int) total;
+        });
+        Json_PathDelete(path);
+
+        // no tree: the "cpu" values straight out of the reader's buffer
+        Json_Reader *reader = Json_ReaderCreate(0);
+        bench("load/stream", corpus, loads, [reader](const string &text) {
+            Json_ReaderSetText(reader, text.c_str(), text.size());
+            size_t total = 0;
+            int event;
+            while ((event = Json_ReaderNext(reader)) > 0) {
+                if (event == Json_EventKey && !strcmp(Json_ReaderItem(reader)->valuestring, "cpu")
+                    && Json_ReaderNext(reader) == Json_EventValue) {
+                    total += strlen(Json_ReaderItem(reader)->valuestring);
+                }
+            }
+            sink = (int) total;
+        });
+        Json_ReaderDestroy(reader);
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *cpusetFile = argc > 1 ? argv[1] : DEFAULT_CPUSET_FILE;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+
+    Json_Hooks hooks = {countingMalloc, free};
+    Json_InitHooks(&hooks);
+
+    vector<Corpus> corpora;
+    corpora.push_back({"scene/app", SCENE_APP});
+    corpora.push_back({"scene/battery", SCENE_BATTERY});
+
+    string cpuset = readFile(cpusetFile);
+    if (cpuset.empty()) {
+        printf("can't read %s, skip cpuset corpus\n", cpusetFile);
+    } else {
+        corpora.push_back({"config/cpuset", cpuset});
+    }
+
+    printf("structural scanner: %s, %d iterations\n", Json_ScanImpl(), iterations);
+    for (auto &&corpus : corpora) {
+        benchParse(corpus, iterations);
+    }
+
+    for (auto &&corpus : corpora) {
+        benchPrint(corpus, iterations);
+    }
+
+    for (auto &&corpus : corpora) {
+        benchCopy(corpus, iterations);
+    }
+
+    for (auto &&corpus : corpora) {
+        benchTeardown(corpus, iterations);
+    }
+
+    for (auto &&corpus : corpora) {
+        benchTape(corpus, iterations);
+    }
+
+    // documents far past anything the HAL sees today, a hundredth of the iterations
+    vector<Corpus> synthetic;
+    synthetic.push_back({"synthetic/object", appTypeDb(8192)});
+    synthetic.push_back({"synthetic/array", numberArray(32768, true)});
+    synthetic.push_back({"synthetic/nested", cpusetPolicy(64, 64)});
+    for (auto &&corpus : synthetic) {
+        printf("%-20s %-22s %10zu bytes\n", corpus.name.c_str(), "size", corpus.text.size());
+        benchParse(corpus, iterations / 100 + 1);
+        benchPrint(corpus, iterations / 100 + 1);
+        benchCopy(corpus, iterations / 100 + 1);
+        benchTeardown(corpus, iterations / 100 + 1);
+        benchTape(corpus, iterations / 100 + 1);
+    }
+
+    benchNumbers(iterations);
+    benchLookup(iterations);
+    benchAtoms(iterations);
+    benchScene(iterations);
+    benchBinary(iterations);
+    benchArray(iterations);
+
+    return 0;
+}
@@ -24,9 +24,15 @@
 #include "policy/cpu_policy_agent.h"
 
 
+//the coalescing window of scene updates in milliseconds, 0 applies each one at once
+#define SCENE_WINDOW_PROPERTY "persist.vendor.j007engine.scene_window_ms"
+#define SCENE_WINDOW_DEFAULT 50
+
 J007Engine *J007Engine::sInstance = NULL;
 
-J007Engine::J007Engine() {
+J007Engine::J007Engine()
+        : mCoalescer([this](uint32_t changed) { applyScene(changed); },
+                     property_get_int32(SCENE_WINDOW_PROPERTY, SCENE_WINDOW_DEFAULT)) {
     initAgent();
 }
 
@@ -52,15 +58,16 @@ void J007Engine::addAgents(string flag, PolicyAgent *agent) {
     mAgentMap.insert(pair<string, PolicyAgent *>(flag, agent));
 }
 
-bool J007Engine::notifyCpuAgentAppSwitch() {
+bool J007Engine::notifyCpuAgentAppSwitch(const Scene &scene, uint32_t changed, string &policy) {
     if (!mAgentMap.count(CPU_POLICY_AGENT)) {
         return false;
     }
-    App app = GlobalScene::getInstance()->getApp();
-    SourceScene sourceScene = GlobalScene::getInstance()->getSourceScene();
-    string status = sourceScene.status;
-    string packageName = sourceScene.packageName;
-    mAgentMap[CPU_POLICY_AGENT]->onAppSwitch(app, status, packageName);
+    //app and source from one published scene, read in place
+    PolicyAgent *agent = mAgentMap[CPU_POLICY_AGENT];
+    if ((changed & agent->getSceneFields()) != 0) {
+        agent->onAppSwitch(scene.app, scene.source.status, scene.source.packageName);
+    }
+    policy = agent->getPolicy();
     return true;
 }
 
@@ -140,17 +147,101 @@ void J007Engine::onResponse(TCode code, string messages) {
 Return<bool>
 J007Engine::notifySceneChanged(const int32_t factors, const hidl_string &status, const hidl_string &packageName) {
     if (DEBUG) {
-        ALOGI("notify scene changed, factors = %d , status = %s , packageName = %s\n", factors, status.c_str(),
+        ALOGI("notify scene changed, factors = %d , status = %zu bytes , packageName = %s\n", factors, status.size(),
               packageName.c_str());
     }
-    GlobalScene::getInstance()->updateScene(factors, status.c_str(), packageName.c_str());
-    if (SCENE_FACTOR_APP == factors) {
-        notifyCpuAgentAppSwitch();
+    //text json only: a Json_Binary status holds bytes a java String can't carry, it comes
+    //through notifySceneChangedBinary
+    if (Json_IsBinary(status.c_str(), status.size())) {
+        LOGW("binary status in notifySceneChanged, factors = %d", factors);
+        return false;
     }
 
+    postScene(factors, GlobalScene::getInstance()->updateScene(factors, status.c_str(), packageName.c_str()));
+    return true;
+}
+
+Return<bool> J007Engine::notifyAppSwitch(const AppScene &app) {
+    App scene;
+    scene.packageName = app.packageName;
+    scene.type = app.type;
+    scene.mode = app.mode;
+    scene.fps = app.fps;
+    scene.cpu = app.cpu;
+    scene.memc = app.memc;
+
+    postScene(SCENE_FACTOR_APP, GlobalScene::getInstance()->updateApp(scene));
+    return true;
+}
+
+Return<bool> J007Engine::notifyBattery(const BatteryScene &battery) {
+    Battery scene;
+    scene.level = battery.level;
+    scene.pluggedIn = battery.pluggedIn;
+    scene.status = battery.status;
+    scene.health = battery.health;
+    scene.temperature = battery.temperature;
+
+    postScene(SCENE_FACTOR_BATTERY, GlobalScene::getInstance()->updateBattery(scene));
     return true;
 }
 
+Return<bool> J007Engine::notifySceneChangedBinary(const int32_t factors, const hidl_vec <uint8_t> &status,
+                                                  const hidl_string &packageName) {
+    if (DEBUG) {
+        ALOGI("notify scene changed, factors = %d , status = %zu bytes binary , packageName = %s\n", factors,
+              status.size(), packageName.c_str());
+    }
+    //the bytes as they are, 0 included: GlobalScene tells Json_Binary from text by its magic
+    string binary(reinterpret_cast<const char *>(status.data()), status.size());
+    if (!Json_IsBinary(binary.data(), binary.size())) {
+        LOGW("status without Json_Binary magic, factors = %d", factors);
+        return false;
+    }
+
+    postScene(factors, GlobalScene::getInstance()->updateScene(factors, binary, packageName.c_str()));
+    return true;
+}
+
+void J007Engine::postScene(int32_t factors, const GlobalScene::SceneRef &scene) {
+    if (scene.isEmpty()) {
+        return;
+    }
+
+    //every transition is kept, however many of them the agents take at once
+    mHistory.record(*scene);
+    mCoalescer.post(factors, scene->changed);
+}
+
+void J007Engine::applyScene(uint32_t changed) {
+    //the updates merged into this call are all in the current scene
+    GlobalScene::SceneRef scene = GlobalScene::getInstance()->acquireScene();
+    string policy;
+    notifyCpuAgentAppSwitch(*scene, changed, policy);
+    mHistory.recordPolicy(scene->version, policy.c_str());
+}
+
+Return<void> J007Engine::debug(const hidl_handle &fd, const hidl_vec <hidl_string> &options) {
+    if (fd.getNativeHandle() == nullptr || fd->numFds < 1) {
+        return Return<void>();
+    }
+
+    int out = fd->data[0];
+    if (options.size() == 2 && options[0] == "window") {
+        mCoalescer.setWindow(atoi(options[1].c_str()));
+    }
+
+    SceneCoalescer::Stats stats;
+    mCoalescer.getStats(stats);
+    dprintf(out, "scene window: %d ms\n", mCoalescer.getWindow());
+    dprintf(out, "scene updates: %llu received, %llu applied, %llu merged\n",
+            (unsigned long long) stats.received, (unsigned long long) stats.applied,
+            (unsigned long long) stats.merged);
+    dprintf(out, "scene transitions: %llu\n", (unsigned long long) mHistory.getCount());
+
+    return Return<void>();
+}
+
 Return<bool> J007Engine::setConfig(const TCode code, const hidl_string &val) {
     if (DEBUG) {
         LOGI("set config code = %d , messages = %s\n", code, val.c_str());
@@ -227,3 +318,26 @@ J007Engine::getPackageName(const int32_t pid, IJ007Engine::getPackageName_cb _hi
 
     return Return<void>();
 }
+
+Return<void> J007Engine::getSceneHistory(const uint32_t maxEntries, IJ007Engine::getSceneHistory_cb _hidl_cb) {
+    vector<SceneHistory::Entry> entries;
+    mHistory.getEntries(maxEntries, entries);
+
+    hidl_vec<SceneTransition> history;
+    history.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        history[i].timestamp = entries[i].timestamp;
+        history[i].version = entries[i].version;
+        history[i].factors = entries[i].factors;
+        history[i].packageName = entries[i].packageName;
+        history[i].appType = entries[i].appType;
+        history[i].policy = entries[i].policy;
+    }
+    if (DEBUG) {
+        LOGI("scene history, %zu of %llu transitions\n", entries.size(),
+             (unsigned long long) mHistory.getCount());
+    }
+
+    _hidl_cb(history);
+    return Return<void>();
+}
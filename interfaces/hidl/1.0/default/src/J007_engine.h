@@ -26,17 +26,24 @@
 #include <hidl/HidlTransportSupport.h>
 #include <hidl/MQDescriptor.h>
 #include <cutils/properties.h>
-#include <com/journeyOS/J007engine/hidl/1.0/IJ007Engine.h>
 #include <com/journeyOS/J007engine/hidl/1.0/types.h>
+#include <com/journeyOS/J007engine/hidl/1.1/IJ007Engine.h>
+#include <com/journeyOS/J007engine/hidl/1.1/types.h>
 
 #include "policy/policy_agent.h"
+#include "scene_coalescer.h"
+#include "scene_history.h"
 
-using ::com::journeyOS::J007engine::hidl::V1_0::IJ007Engine;
+using ::com::journeyOS::J007engine::hidl::V1_1::IJ007Engine;
 using ::com::journeyOS::J007engine::hidl::V1_0::IJ007EngineCallback;
 using ::com::journeyOS::J007engine::hidl::V1_0::Status;
 using ::com::journeyOS::J007engine::hidl::V1_0::TCode;
 using ::com::journeyOS::J007engine::hidl::V1_0::J007EngineResponse;
+using ::com::journeyOS::J007engine::hidl::V1_1::AppScene;
+using ::com::journeyOS::J007engine::hidl::V1_1::BatteryScene;
+using ::com::journeyOS::J007engine::hidl::V1_1::SceneTransition;
 using ::android::hardware::hidl_death_recipient;
+using ::android::hardware::hidl_handle;
 using ::android::hardware::hidl_string;
 using ::android::hardware::hidl_vec;
 using ::android::hardware::interfacesEqual;
@@ -83,10 +90,29 @@ public:
     Return<void>
     getPackageName(const int32_t pid, IJ007Engine::getPackageName_cb _hidl_cb) override;
 
+    Return<bool> notifyAppSwitch(const AppScene &app) override;
+
+    Return<bool> notifyBattery(const BatteryScene &battery) override;
+
+    Return<bool> notifySceneChangedBinary(const int32_t factors, const hidl_vec <uint8_t> &status,
+                                          const hidl_string &packageName) override;
+
+    Return<void> getSceneHistory(const uint32_t maxEntries, IJ007Engine::getSceneHistory_cb _hidl_cb) override;
+
+    //lshal debug: the coalescing counters, "window <ms>" sets the window
+    Return<void> debug(const hidl_handle &fd, const hidl_vec <hidl_string> &options) override;
+
 private:
     void initAgent();
 
-    bool notifyCpuAgentAppSwitch();
+    //a scene an update published (none for a repeat) to the history, and on to mCoalescer
+    void postScene(int32_t factors, const GlobalScene::SceneRef &scene);
+
+    //the current scene to the agents watching a field of changed, their policy to the history.
+    //Called by mCoalescer, once for updates that came close together
+    void applyScene(uint32_t changed);
+
+    bool notifyCpuAgentAppSwitch(const Scene &scene, uint32_t changed, string &policy);
 
     bool unregisterCallbackInternal(const sp <IBase> &cb);
 
@@ -100,6 +126,12 @@ private:
     string mConfigs = "";
 
     map<string, PolicyAgent*> mAgentMap;
+
+    //every scene published, with the policy the agents applied for it
+    SceneHistory mHistory;
+
+    //between the updates and the agents, last: it may call applyScene as soon as it is built
+    SceneCoalescer mCoalescer;
 };
 
 
@@ -14,20 +14,34 @@
  * limitations under the License.
  */
 
+#include <string.h>
+#include <thread>
+
 #include "global_scene.h"
 #include "log.h"
 #include "factors.h"
-#include "json/json_object.h"
 
 #define LOG_TAG        "J007Engine-GlobalScene"
 
 GlobalScene *GlobalScene::sInstance = NULL;
 
-GlobalScene::GlobalScene() {
+//members of the scene, as atoms: the scenes parse their keys to the same pointers
+static const char *const sAppKey = Json_Intern("app");
+static const char *const sBatteryKey = Json_Intern("battery");
+
+GlobalScene::GlobalScene()
+        : mSourceScene(), mApp(), mBattery(), mBrightness(0), mVersion(0), mCurrent(0), mScene(NULL), mArena(NULL) {
+    memset(mStatusHash, 0, sizeof(mStatusHash));
+    for (SceneSlot &slot : mSlots) {
+        slot.refs.store(0);
+        slot.scene = Scene();
+    }
     initConfig();
 }
 
 GlobalScene::~GlobalScene() {
+    Json_Delete(mScene);
+    Json_ArenaDestroy(mArena);
 }
 
 GlobalScene *GlobalScene::getInstance() {
@@ -40,13 +54,85 @@ GlobalScene *GlobalScene::getInstance() {
 
 void GlobalScene::initConfig() {
     ALOGI("init global scene...");
+    mScene = Json_CreateObject();
+    mArena = Json_ArenaCreate(0);
+    if (!JsonBinding::Intern<App>() || !JsonBinding::Intern<Battery>() || sAppKey == NULL || sBatteryKey == NULL) {
+        LOGE("intern scene keys failed, out of memory");
+    }
     //TODO
 }
 
-void GlobalScene::updateScene(int32_t factors, string status, string packageName) {
+//the status for logs: text as is, a Json_Binary scene only by its size
+static string describeStatus(const string &status) {
+    if (!Json_IsBinary(status.data(), status.size())) {
+        return status;
+    }
+
+    return "(binary, " + to_string(status.size()) + " bytes)";
+}
+
+static uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint64_t hashWord(uint64_t hash, uint64_t word) {
+    hash ^= word * 0x87c37b91114253d5ull;
+    return (hash << 31 | hash >> 33) * 0x4cf5ad432745937full;
+}
+
+//64 bits of the raw bytes, 16 at a time in two independent lanes: only for telling a repeat,
+//never 0
+static uint64_t hashBytes(const char *data, size_t len, uint64_t hash) {
+    uint64_t other = hash ^ 0x9e3779b97f4a7c15ull;
+    uint64_t word[2];
+
+    hash ^= len;
+    for (; len >= 16; data += 16, len -= 16) {
+        memcpy(word, data, 16);
+        hash = hashWord(hash, word[0]);
+        other = hashWord(other, word[1]);
+    }
+    word[0] = word[1] = 0;
+    memcpy(word, data, len);
+    hash = mixHash(hashWord(hash, word[0]) ^ hashWord(other, word[1]));
+
+    return hash != 0 ? hash : 1;
+}
+
+static uint64_t hashStatus(const string &status, const string &packageName) {
+    return hashBytes(packageName.data(), packageName.size(), hashBytes(status.data(), status.size(), 0));
+}
+
+//the status hash slot of factors, -1 unless it is one factor
+static int factorBit(int32_t factors) {
+    if (factors <= 0 || (factors & (factors - 1)) != 0) {
+        return -1;
+    }
+
+    return __builtin_ctz(factors);
+}
+
+GlobalScene::SceneRef GlobalScene::updateScene(int32_t factors, string status, string packageName) {
     if (DEBUG) {
-        LOGI("notify scene changed, factors = %d , status = %s , packageName = %s\n", factors, status.c_str(),
-             packageName.c_str());
+        LOGI("notify scene changed, factors = %d , status = %s , packageName = %s\n", factors,
+             describeStatus(status).c_str(), packageName.c_str());
+    }
+
+    //NotifyManager sends the state on every monitor event, mostly the same again: those are
+    //known by the bytes alone, nothing to parse or publish
+    uint64_t hash = hashStatus(status, packageName);
+    int bit = factorBit(factors);
+
+    lock_guard<mutex> lock(mUpdateLock);
+
+    if (bit >= 0 && mStatusHash[bit] == hash) {
+        LOGD("scene repeated, factors = %d", factors);
+        return SceneRef(NULL);
     }
 
     //update source scene
@@ -54,15 +140,161 @@ void GlobalScene::updateScene(int32_t factors, string status, string packageName
     mSourceScene.status = status;
     mSourceScene.packageName = packageName;
 
-    JsonObject oJson(status);
+    //a status merged whole may have changed the members of other factors under their statuses
+    if (parseScene(factors, status)) {
+        memset(mStatusHash, 0, sizeof(mStatusHash));
+    }
+    if (bit >= 0) {
+        mStatusHash[bit] = hash;
+    }
+    return SceneRef(publishScene());
+}
+
+GlobalScene::SceneRef GlobalScene::updateApp(const App &app) {
+    if (DEBUG) {
+        LOGI("app switch, packageName = %s , type = %s\n", app.packageName.c_str(), app.type.c_str());
+    }
+
+    lock_guard<mutex> lock(mUpdateLock);
+
+    mSourceScene.factors = SCENE_FACTOR_APP;
+    mSourceScene.status.clear();
+    mSourceScene.packageName = app.packageName;
+
+    mApp = app;
+    mStatusHash[factorBit(SCENE_FACTOR_APP)] = 0;
+    if (mScene != NULL) {
+        Json_DeleteItemFromObject(mScene, sAppKey);
+    }
+    return SceneRef(publishScene());
+}
+
+GlobalScene::SceneRef GlobalScene::updateBattery(const Battery &battery) {
+    if (DEBUG) {
+        LOGI("battery changed, level = %d , temperature = %d\n", battery.level, battery.temperature);
+    }
+
+    lock_guard<mutex> lock(mUpdateLock);
+
+    mSourceScene.factors = SCENE_FACTOR_BATTERY;
+    mSourceScene.status.clear();
+    mSourceScene.packageName = mApp.packageName;
+
+    mBattery = battery;
+    mStatusHash[factorBit(SCENE_FACTOR_BATTERY)] = 0;
+    if (mScene != NULL) {
+        Json_DeleteItemFromObject(mScene, sBatteryKey);
+    }
+    return SceneRef(publishScene());
+}
+
+uint32_t GlobalScene::diffScene(const Scene &scene) {
+    uint32_t changed = 0;
+    if (scene.version == 0) {
+        return SCENE_FIELDS_ALL;
+    }
+
+    changed |= mApp.packageName != scene.app.packageName ? SCENE_FIELD_APP_PACKAGE_NAME : 0;
+    changed |= mApp.type != scene.app.type ? SCENE_FIELD_APP_TYPE : 0;
+    changed |= mApp.mode != scene.app.mode ? SCENE_FIELD_APP_MODE : 0;
+    changed |= mApp.fps != scene.app.fps ? SCENE_FIELD_APP_FPS : 0;
+    changed |= mApp.cpu != scene.app.cpu ? SCENE_FIELD_APP_CPU : 0;
+    changed |= mApp.memc != scene.app.memc ? SCENE_FIELD_APP_MEMC : 0;
+    changed |= mBattery.level != scene.battery.level ? SCENE_FIELD_BATTERY_LEVEL : 0;
+    changed |= mBattery.pluggedIn != scene.battery.pluggedIn ? SCENE_FIELD_BATTERY_PLUGGED_IN : 0;
+    changed |= mBattery.status != scene.battery.status ? SCENE_FIELD_BATTERY_STATUS : 0;
+    changed |= mBattery.health != scene.battery.health ? SCENE_FIELD_BATTERY_HEALTH : 0;
+    changed |= mBattery.temperature != scene.battery.temperature ? SCENE_FIELD_BATTERY_TEMPERATURE : 0;
+    changed |= mBrightness != scene.brightness ? SCENE_FIELD_BRIGHTNESS : 0;
+
+    return changed;
+}
+
+GlobalScene::SceneSlot *GlobalScene::publishScene() {
+    int current = mCurrent.load();
+    int slot = -1;
+
+    //readers only keep a slot briefly: one frees up soon even when all are held
+    while (true) {
+        for (int i = 0; i < SCENE_SLOTS && slot < 0; i++) {
+            if (i != current && mSlots[i].refs.load() == 0) {
+                slot = i;
+            }
+        }
+
+        if (slot >= 0) {
+            break;
+        }
+        this_thread::yield();
+    }
+
+    //reused strings keep their capacity: no allocation once the slots have seen a scene or two
+    Scene &scene = mSlots[slot].scene;
+    scene.version = ++mVersion;
+    scene.changed = diffScene(mSlots[current].scene);
+    scene.source = mSourceScene;
+    scene.app = mApp;
+    scene.battery = mBattery;
+    scene.brightness = mBrightness;
+
+    mSlots[slot].refs.fetch_add(1);
+    mCurrent.store(slot);
+    return &mSlots[slot];
+}
+
+GlobalScene::SceneRef GlobalScene::acquireScene() {
+    while (true) {
+        int current = mCurrent.load();
+        mSlots[current].refs.fetch_add(1);
+
+        //still current: no update can reuse the slot before this reference goes away.
+        //Otherwise an update may be rewriting it, try the new current one
+        if (mCurrent.load() == current) {
+            return SceneRef(&mSlots[current]);
+        }
+        mSlots[current].refs.fetch_sub(1);
+    }
+}
+
+GlobalScene::SceneRef::SceneRef(SceneRef &&ref) : mSlot(ref.mSlot) {
+    ref.mSlot = NULL;
+}
+
+GlobalScene::SceneRef::~SceneRef() {
+    if (mSlot != NULL) {
+        mSlot->refs.fetch_sub(1);
+    }
+}
+
+bool GlobalScene::parseScene(int32_t factors, const string &status) {
+    if (mScene == NULL || mArena == NULL || sAppKey == NULL || sBatteryKey == NULL) {
+        return false;
+    }
+
+    //text json or Json_Binary, a whole scene or only the members that changed: applied as a
+    //merge patch (RFC 7386) either way, so a delta never costs a full scene.
+    //Text is parsed lazily: only the member of the factor is built and merged, the others
+    //are checked and skipped, each is kept current by the updates of its own factor
+    const char *member = factors == SCENE_FACTOR_APP ? sAppKey
+                         : factors == SCENE_FACTOR_BATTERY ? sBatteryKey : NULL;
+    bool binary = Json_IsBinary(status.data(), status.size());
+    Json *patch = binary ? Json_ParseBinary(status.data(), status.size())
+                  : member != NULL ? Json_ParseMembersInArena(status.c_str(), &member, 1, mArena)
+                                   : Json_ParseInArena(status.c_str(), mArena);
+    if (patch == NULL || (patch->type & 255) != Json_Object) {
+        LOGW("bad scene %s", describeStatus(status).c_str());
+    } else if (!Json_MergePatch(mScene, patch, 0)) {
+        LOGE("merge scene failed, out of memory");
+    }
+    Json_Delete(patch);
+    Json_ArenaReset(mArena);
+
     switch (factors) {
         case SCENE_FACTOR_APP:
-            oJson["app"].Get("packageName", mApp.packageName);
-            oJson["app"].Get("type", mApp.type);
-            oJson["app"].Get("mode", mApp.mode);
-            oJson["app"].Get("fps", mApp.fps);
-            oJson["app"].Get("cpu", mApp.cpu);
-            oJson["app"].Get("memc", mApp.memc);
+            if (!JsonBinding::Decode(Json_GetObjectItemByAtom(mScene, sAppKey, 0), mApp)) {
+                LOGW("no app in scene %s", describeStatus(status).c_str());
+            }
+            LOGD("app = %s", JsonBinding::Encode(mApp).c_str());
             break;
         case SCENE_FACTOR_LCD:
             //TODO
@@ -81,24 +313,28 @@ void GlobalScene::updateScene(int32_t factors, string status, string packageName
         case SCENE_FACTOR_BATTERY:
             //TODO
 
-            oJson["battery"].Get("temperature", mBattery.temperature);
+            if (!JsonBinding::Decode(Json_GetObjectItemByAtom(mScene, sBatteryKey, 0), mBattery)) {
+                LOGW("no battery in scene %s", describeStatus(status).c_str());
+            }
             LOGI("battery temperature  = %d ", mBattery.temperature);
             break;
     }
+
+    return binary || member == NULL;
 }
 
 SourceScene GlobalScene::getSourceScene() {
-    return mSourceScene;
+    return acquireScene()->source;
 }
 
 App GlobalScene::getApp() {
-    return mApp;
+    return acquireScene()->app;
 }
 
 Battery GlobalScene::getBattery() {
-    return mBattery;
+    return acquireScene()->battery;
 }
 
 long GlobalScene::getBrightness() {
-    return mBrightness;
+    return acquireScene()->brightness;
 }
\ No newline at end of file
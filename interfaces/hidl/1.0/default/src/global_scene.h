@@ -19,8 +19,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
 #include <string>
 
+#include "json/json_binding.h"
+
+extern "C" {
+#include "json/json_arena.h"
+}
+
 using namespace std;
 
 struct SourceScene {
@@ -46,16 +55,115 @@ struct Battery {
     int temperature;
 };
 
+JSON_SCHEMA(SourceScene,
+            JSON_FIELD(SourceScene, factors),
+            JSON_FIELD(SourceScene, status),
+            JSON_FIELD(SourceScene, packageName))
+
+JSON_SCHEMA(App,
+            JSON_FIELD(App, packageName),
+            JSON_FIELD(App, type),
+            JSON_FIELD(App, mode),
+            JSON_FIELD(App, fps),
+            JSON_FIELD(App, cpu),
+            JSON_FIELD(App, memc))
+
+JSON_SCHEMA(Battery,
+            JSON_FIELD(Battery, level),
+            JSON_FIELD(Battery, pluggedIn),
+            JSON_FIELD(Battery, status),
+            JSON_FIELD(Battery, health),
+            JSON_FIELD(Battery, temperature))
+
+//fields of a scene, for Scene::changed and for what an agent watches
+#define SCENE_FIELD_APP_PACKAGE_NAME    (1 << 0)
+#define SCENE_FIELD_APP_TYPE            (1 << 1)
+#define SCENE_FIELD_APP_MODE            (1 << 2)
+#define SCENE_FIELD_APP_FPS             (1 << 3)
+#define SCENE_FIELD_APP_CPU             (1 << 4)
+#define SCENE_FIELD_APP_MEMC            (1 << 5)
+#define SCENE_FIELD_BATTERY_LEVEL       (1 << 6)
+#define SCENE_FIELD_BATTERY_PLUGGED_IN  (1 << 7)
+#define SCENE_FIELD_BATTERY_STATUS      (1 << 8)
+#define SCENE_FIELD_BATTERY_HEALTH      (1 << 9)
+#define SCENE_FIELD_BATTERY_TEMPERATURE (1 << 10)
+#define SCENE_FIELD_BRIGHTNESS          (1 << 11)
+
+#define SCENE_FIELDS_APP                (0x3f << 0)
+#define SCENE_FIELDS_BATTERY            (0x1f << 6)
+#define SCENE_FIELDS_ALL                (~0u)
+
+//everything one updateScene left behind, published as a whole and never changed afterwards
+struct Scene {
+    uint64_t version;
+    //SCENE_FIELD_*: what differs from the scene published before
+    uint32_t changed;
+    SourceScene source;
+    App app;
+    Battery battery;
+    long brightness;
+};
+
 class GlobalScene {
+private:
+    struct SceneSlot;
+
 public:
+    //a reader's hold on the scene published last: taken with no lock and no copy, it keeps
+    //showing that same scene however many updates come meanwhile. Hold it briefly, on one thread:
+    //an update waits for a free slot while every other slot is held
+    class SceneRef {
+    public:
+        SceneRef(SceneRef &&ref);
+
+        ~SceneRef();
+
+        const Scene &operator*() const {
+            return mSlot->scene;
+        }
+
+        const Scene *operator->() const {
+            return &mSlot->scene;
+        }
+
+        //no scene: the update was a repeat and published nothing
+        bool isEmpty() const {
+            return mSlot == NULL;
+        }
+
+    private:
+        friend class GlobalScene;
+
+        explicit SceneRef(SceneSlot *slot) : mSlot(slot) {
+        }
+
+        SceneRef(const SceneRef &ref);
+
+        SceneRef &operator=(const SceneRef &ref);
+
+        SceneSlot *mSlot;
+    };
+
     GlobalScene();
 
     ~GlobalScene();
 
     static GlobalScene *getInstance();
 
-    void updateScene(int32_t factors, string status, string packageName);
+    //from any thread: updates are applied one at a time, readers never wait for them.
+    //Returns a hold on the scene this update published, later ones may be current already.
+    //A status byte for byte the one the factor sent last is dropped unparsed: the hold is empty
+    SceneRef updateScene(int32_t factors, string status, string packageName);
+
+    //typed updates (IJ007Engine 1.1): the struct is the factor's new state as a whole, nothing
+    //is parsed. The source scene gets an empty status and the packageName of the app in front
+    SceneRef updateApp(const App &app);
+
+    SceneRef updateBattery(const Battery &battery);
 
+    SceneRef acquireScene();
+
+    //copies out of the scene published last
     SourceScene getSourceScene();
 
     App getApp();
@@ -68,12 +176,49 @@ public:
 private:
     static GlobalScene *sInstance;
 
+    //published scenes live in a few slots, reused once no reader holds them, never freed:
+    //a reader may count itself in on a slot that is being replaced, it finds out and retries
+    static const int SCENE_SLOTS = 4;
+
+    struct SceneSlot {
+        std::atomic<int> refs;
+        Scene scene;
+    };
+
     void initConfig();
 
+    //returns whether the status was merged whole, not only the member of its factor
+    bool parseScene(int32_t factors, const string &status);
+
+    //SCENE_FIELD_* the scene being built has changed from scene
+    uint32_t diffScene(const Scene &scene);
+
+    //copies the scene being built into a free slot and makes it the current one,
+    //the slot is returned with a reference taken for the caller
+    SceneSlot *publishScene();
+
+    //the scene being built: only touched by updateScene, under mUpdateLock
     SourceScene mSourceScene;
     App mApp;
     Battery mBattery;
     long mBrightness;
+    uint64_t mVersion;
+
+    //hash of the status each factor (by bit) sent last, 0 when it is not to be trusted: the state
+    //of the factor has changed by other ways since
+    uint64_t mStatusHash[32];
+
+    std::mutex mUpdateLock;
+    SceneSlot mSlots[SCENE_SLOTS];
+    std::atomic<int> mCurrent;
+
+    //every status is merged into this document (a full scene, or only what changed),
+    //mApp, mBattery... are decoded from it. A typed update drops the member of its factor:
+    //the member then only holds what statuses changed since, decoded over the struct
+    Json *mScene;
+
+    //the text status being merged
+    Json_Arena *mArena;
 };
 
 
@@ -23,6 +23,11 @@
 #include <ctype.h>
 
 #include "json.h"
+#include "json_atom.h"
+#include "json_scan.h"
+#include "json_arena.h"
+#include "json_number.h"
+#include "json_binary.h"
 
 #ifndef INT_MAX
 #define INT_MAX 2147483647
@@ -39,18 +44,42 @@ static void *(*Json_malloc)(size_t sz) = malloc;
 
 static void (*Json_free)(void *ptr) = free;
 
+/* Set for the duration of Json_ParseInArena on this thread. */
+static __thread Json_Arena *parse_arena;
+
+/* Set for the duration of Json_ParseInSitu on this thread. */
+static __thread int parse_insitu;
+
 /* Predeclare these prototypes. */
 static const char *parse_value(Json *item, const char *value);
 
-static char *print_value(Json *item, int depth, int fmt);
+/*
+ * Output of the printers: text is appended at offset, the buffer grows as needed.
+ */
+typedef struct {
+    char *buffer;
+    size_t length;
+    size_t offset;
+} printbuffer;
+
+static int print_value(Json *item, int depth, int fmt, printbuffer *p);
+
+static int print_literal(const char *str, size_t len, printbuffer *p);
+
+static size_t print_estimate(Json *item, int depth, int fmt);
 
 static const char *parse_array(Json *item, const char *value);
 
-static char *print_array(Json *item, int depth, int fmt);
+static int print_array(Json *item, int depth, int fmt, printbuffer *p);
 
 static const char *parse_object(Json *item, const char *value);
 
-static char *print_object(Json *item, int depth, int fmt);
+static int print_object(Json *item, int depth, int fmt, printbuffer *p);
+
+static const char *skip(const char *in);
+
+typedef struct Json_KeyIndex Json_KeyIndex;
+typedef struct Json_ArrayIndex Json_ArrayIndex;
 
 const char *Json_GetErrorPtr() {
     return ep;
@@ -99,18 +128,72 @@ void Json_InitHooks(Json_Hooks *hooks) {
     Json_free = (hooks->free_fn) ? hooks->free_fn : free;
 }
 
+/*
+ * Allocation of parsed nodes and strings, from the arena when there is one.
+ */
+static void *parse_malloc(size_t sz) {
+    return parse_arena ? Json_ArenaAlloc(parse_arena, sz) : Json_malloc(sz);
+}
+
 /*
  * Internal constructor.
  */
 static Json *Json_New_Item() {
-    Json *node = (Json *) Json_malloc(sizeof(Json));
+    Json *node = (Json *) parse_malloc(sizeof(Json));
     if (node) {
         memset(node, 0, sizeof(Json));
+        if (parse_arena) {
+            node->flags = Json_ArenaNode;
+        }
     }
 
     return node;
 }
 
+/*
+ * An object member was parsed as a string: it is the key.
+ */
+static void move_key(Json *item) {
+    item->string = item->valuestring;
+    item->valuestring = 0;
+    if (item->flags & Json_BorrowedValueString) {
+        item->flags = (item->flags & ~Json_BorrowedValueString) | Json_BorrowedString;
+    }
+}
+
+/*
+ * The len bytes at str are a key, unescaped: when they are interned, the item
+ * takes the atom (json_atom.h) and nothing is copied.
+ */
+static int atom_key(Json *item, const char *str, size_t len) {
+    const char *atom = Json_AtomFind(str, len);
+    if (!atom) {
+        return 0;
+    }
+
+    item->string = (char *) atom;
+    item->flags |= Json_BorrowedString | Json_AtomString;
+    return 1;
+}
+
+/*
+ * A key of its own for item: the atom when string is interned, a copy otherwise.
+ * Returns 0 on memory fail.
+ */
+static int set_key(Json *item, const char *string) {
+    if (item->string && !(item->flags & Json_BorrowedString)) {
+        Json_free(item->string);
+    }
+
+    item->flags &= ~(Json_BorrowedString | Json_AtomString);
+    if (atom_key(item, string, strlen(string))) {
+        return 1;
+    }
+
+    item->string = Json_strdup(string);
+    return item->string != 0;
+}
+
 /*
  * Delete a Json structure.
  */
@@ -122,28 +205,39 @@ void Json_Delete(Json *c) {
             Json_Delete(c->child);
         }
 
-        if (!(c->type & Json_IsReference) && c->valuestring) {
+        if (!(c->type & Json_IsReference) && c->valuestring && !(c->flags & Json_BorrowedValueString)) {
             Json_free(c->valuestring);
         }
 
-        if (c->string) {
+        if (c->string && !(c->flags & Json_BorrowedString)) {
             Json_free(c->string);
         }
 
-        Json_free(c);
+        if (c->index.keys) {
+            Json_free(c->index.keys);   /* either table, same pointer */
+        }
+
+        if (!(c->flags & Json_ArenaNode)) {
+            Json_free(c);
+        }
         c = next;
     }
 }
 
+/* -2^63, the most negative integer valueint holds */
+#define JSON_INT_MIN_MAGNITUDE 9223372036854775808ULL
+
 /*
  * Parse the input text to generate a number, and populate the result into item.
  */
 static const char *parse_number(Json *item, const char *num) {
-    long double n = 0, scale = 0;
-    int subscale = 0, signsubscale = 1;
+    const char *start = num, *integer;
+    uint64 w = 0, magnitude;
+    int digits = 0, dropped = 0, inexact = 0, fraction = 0;
+    int exp10 = 0, subscale = 0, signsubscale = 1;
+    double d, d2;
     item->sign = 1;
 
-    /* Could use sscanf for this */
     if (*num == '-') {
         item->sign = -1, num++; /* Has sign */
     }
@@ -152,17 +246,33 @@ static const char *parse_number(Json *item, const char *num) {
         num++; /* is zero */
     }
 
+    /*
+     * The first 19 significant digits go to w exactly, the rest only count
+     * towards the exponent.
+     */
+    integer = num;
     if (*num >= '1' && *num <= '9') {
         do {
-            n = (n * 10.0) + (*num++ - '0');
+            if (digits < 19) {
+                w = w * 10 + (*num - '0'), digits++;
+            } else {
+                inexact |= *num != '0', dropped++;
+            }
+            num++;
         } while (*num >= '0' && *num <= '9'); /* Number */
     }
 
     /* Fractional part? */
     if (*num == '.' && num[1] >= '0' && num[1] <= '9') {
-        num++;
+        num++, fraction = 1;
         do {
-            n = (n * 10.0) + (*num++ - '0'), scale--;
+            if (digits < 19) {
+                w = w * 10 + (*num - '0'), exp10--;
+                digits += w != 0;
+            } else {
+                inexact |= *num != '0';
+            }
+            num++;
         } while (*num >= '0' && *num <= '9');
     }
 
@@ -176,95 +286,197 @@ static const char *parse_number(Json *item, const char *num) {
         }
 
         while (*num >= '0' && *num <= '9') {
-            subscale = (subscale * 10) + (*num++ - '0'); /* Number? */
+            if (subscale < 100000) {
+                subscale = (subscale * 10) + (*num - '0'); /* Number? */
+            }
+            num++;
         }
     }
 
-    if (scale == 0 && subscale == 0) {
-        item->valuedouble = (double) (item->sign * n);
-        item->valueint = (uint64) (item->sign * (uint64) n);
+    exp10 += dropped + signsubscale * subscale;
+    if (!fraction && subscale == 0 && dropped == 0 && (item->sign == 1 || w <= JSON_INT_MIN_MAGNITUDE)) {
+        /* Integer fast path: w is the exact value. */
+        item->valuedouble = item->sign * (double) w;
+        item->valueint = item->sign == -1 ? 0 - w : w;
         item->type = Json_Int;
-    } else {
-        n = item->sign * n *
-            pow(10.0, (scale + subscale * signsubscale)); /* number = +/- number.fraction * 10^+/- exponent */
-        item->valuedouble = (double) n;
-        item->valueint = (uint64) n;
-        item->type = Json_Double;
+        return num;
+    }
+
+    /* number = +/- w * 10^exp10, nearest double */
+    if (!Json_DecimalToDouble(w, exp10, &d)
+        || (inexact && (!Json_DecimalToDouble(w + 1, exp10, &d2) || d2 != d))) {
+        d = fabs(strtod(start, 0));
+    }
+    d *= item->sign;
+
+    if (!fraction && subscale == 0) {
+        /* an integer too long for w, rebuild as much of it as fits in 64 bits */
+        magnitude = w;
+        for (integer += digits; *integer >= '0' && *integer <= '9'; integer++) {
+            if (magnitude > (~0ULL - (*integer - '0')) / 10) {
+                magnitude = ~0ULL;
+                break;
+            }
+            magnitude = magnitude * 10 + (*integer - '0');
+        }
+
+        /* below -2^63 valueint has nothing for it, the number is only the double */
+        if (item->sign == 1 || magnitude <= JSON_INT_MIN_MAGNITUDE) {
+            item->valuedouble = d;
+            item->valueint = item->sign == -1 ? 0 - magnitude : magnitude;
+            item->type = Json_Int;
+            return num;
+        }
     }
 
+    item->valuedouble = d;
+    item->valueint = (d > -9223372036854775808.0 && d < 9223372036854775808.0) ? (uint64) (int64) d : 0;
+    item->type = Json_Double;
+
     return num;
 }
 
-/* Render the number nicely from the given item into a string. */
-static char *print_double(Json *item) {
-    char *str;
-    double d = item->valuedouble;
-    str = (char *) Json_malloc(64); /* This is a nice tradeoff. */
-    if (str) {
-        if (fabs(d) < 1.0e-6 || fabs(d) > 1.0e9) {
-            sprintf(str, "%lf", d);
-        } else {
-            sprintf(str, "%f", d);
-        }
+/*
+ * Make room for needed more bytes at the end of p.
+ * Returns where they go, or 0 on memory fail (p is freed).
+ */
+static char *ensure(printbuffer *p, size_t needed) {
+    char *newbuffer;
+    size_t newsize;
+    if (!p->buffer) {
+        return 0;
     }
 
-    return str;
+    needed += p->offset;
+    if (needed <= p->length) {
+        return p->buffer + p->offset;
+    }
+
+    newsize = p->length * 2;
+    if (newsize < needed) {
+        newsize = needed;
+    }
+
+    newbuffer = (char *) Json_malloc(newsize);
+    if (!newbuffer) {
+        Json_free(p->buffer);
+        p->buffer = 0;
+        p->length = 0;
+        return 0;
+    }
+
+    memcpy(newbuffer, p->buffer, p->offset);
+    Json_free(p->buffer);
+    p->buffer = newbuffer;
+    p->length = newsize;
+
+    return newbuffer + p->offset;
+}
+
+/* Render the number nicely from the given item into p: the shortest text that reads back the same. */
+static int print_double(Json *item, printbuffer *p) {
+    char *out = ensure(p, JSON_NUMBER_BUFFER);
+    if (!out) {
+        return 0;
+    }
+
+    p->offset += Json_FormatDouble(item->valuedouble, out);
+
+    return 1;
 }
 
-static char *print_int(Json *item) {
-    char *str;
-    str = (char *) Json_malloc(22); /* 2^64+1 can be represented in 21 chars. */
+static int print_int(Json *item, printbuffer *p) {
+    char *out = ensure(p, JSON_NUMBER_BUFFER);
+    if (!out) {
+        return 0;
+    }
+
+    if (item->sign == -1 && (int64) item->valueint < 0) {
+        p->offset += Json_FormatUint64(0 - item->valueint, 1, out);
+    } else {
+        p->offset += Json_FormatUint64(item->valueint, 0, out);
+    }
 
-    if (str) {
-        if (item->sign == -1) {
-            if ((int64) item->valueint <= (int64) INT_MAX
-                && (int64) item->valueint >= (int64) INT_MIN) {
-                sprintf(str, "%d", (int32) item->valueint);
-            } else {
-                sprintf(str, "%lld", (int64) item->valueint);
-            }
+    return 1;
+}
+
+/*
+ * The four hex digits of a \u escape, -1 if they are not all there. Stops at
+ * the first other character, the closing quote or the end of the text.
+ */
+static int parse_hex4(const char *str) {
+    int value = 0, i;
+    char c;
+
+    for (i = 0; i < 4; i++) {
+        c = str[i];
+        if (c >= '0' && c <= '9') {
+            value = value << 4 | (c - '0');
+        } else if ((c | 32) >= 'a' && (c | 32) <= 'f') {
+            value = value << 4 | ((c | 32) - 'a' + 10);
         } else {
-            if (item->valueint <= (uint64) UINT_MAX) {
-                sprintf(str, "%u", (uint32) item->valueint);
-            } else {
-                sprintf(str, "%llu", item->valueint);
-            }
+            return -1;
         }
     }
 
-    return str;
+    return value;
+}
+
+/*
+ * A string that is cut short or holds a bad \u escape: error at where.
+ */
+static const char *string_fail(char *out, const char *where) {
+    if (!parse_arena && !parse_insitu) {
+        Json_free(out);
+    }
+
+    ep = where;
+    return 0;
 }
 
 static const char *parse_string(Json *item, const char *str) {
     const char *ptr = str + 1;
     char *ptr2;
     char *out;
-    int len = 0;
+    int len = 0, code;
     unsigned uc, uc2;
     if (*str != '\"') {
         ep = str;
         return 0;
     } /* not a string! */
 
-    while (*ptr != '\"' && *ptr && ++len) {
-        if (*ptr++ == '\\') {
-            ptr++; /* Skip escaped quotes. */
+    if (parse_insitu) {
+        /* Unescaping never makes a string longer: no sizing pass, and nothing to move up to the first escape. */
+        out = (char *) str + 1;
+        while (*ptr != '\"' && *ptr != '\\' && *ptr) {
+            ptr++;
+        }
+        ptr2 = (char *) ptr;
+    } else {
+        while (*ptr != '\"' && *ptr && ++len) {
+            if (*ptr++ == '\\' && *ptr) {
+                ptr++; /* Skip escaped quotes. */
+            }
         }
-    }
 
-    out = (char *) Json_malloc(len + 1); /* This is how long we need for the string, roughly. */
-    if (!out) {
-        return 0;
+        out = (char *) parse_malloc(len + 1); /* This is how long we need for the string, roughly. */
+        if (!out) {
+            return 0;
+        }
+
+        ptr = str + 1;
+        ptr2 = out;
     }
 
-    ptr = str + 1;
-    ptr2 = out;
     while (*ptr != '\"' && *ptr) {
         if (*ptr != '\\') {
             *ptr2++ = *ptr++;
         } else {
             ptr++;
             switch (*ptr) {
+                case 0:
+                    return string_fail(out, ptr);
+
                 case 'b':
                     *ptr2++ = '\b';
                     break;
@@ -286,7 +498,11 @@ static const char *parse_string(Json *item, const char *str) {
                     break;
 
                 case 'u': /* transcode utf16 to utf8. */
-                    sscanf(ptr + 1, "%4x", &uc);
+                    /* never step past the end of the string: it may be followed by more text, or none */
+                    if ((code = parse_hex4(ptr + 1)) < 0) {
+                        return string_fail(out, ptr - 1);
+                    }
+                    uc = code;
                     ptr += 4; /* get the unicode char. */
 
                     if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0) {
@@ -299,7 +515,10 @@ static const char *parse_string(Json *item, const char *str) {
                             break;    // missing second-half of surrogate.
                         }
 
-                        sscanf(ptr + 3, "%4x", &uc2);
+                        if ((code = parse_hex4(ptr + 3)) < 0) {
+                            return string_fail(out, ptr + 1);
+                        }
+                        uc2 = code;
                         ptr += 6;
                         if (uc2 < 0xDC00 || uc2 > 0xDFFF) {
                             break;    // invalid second-half of surrogate.
@@ -346,13 +565,19 @@ static const char *parse_string(Json *item, const char *str) {
         }
     }
 
-    *ptr2 = 0;
-    if (*ptr == '\"') {
-        ptr++;
+    if (*ptr != '\"') {
+        return string_fail(out, str); /* unterminated */
     }
 
+    /* In situ the terminator may land on the closing quote: step over it first. */
+    ptr++;
+    *ptr2 = 0;
+
     item->valuestring = out;
     item->type = Json_String;
+    if (parse_arena || parse_insitu) {
+        item->flags |= Json_BorrowedValueString;
+    }
 
     return ptr;
 }
@@ -360,14 +585,14 @@ static const char *parse_string(Json *item, const char *str) {
 /*
  * Render the cstring provided to an escaped version that can be printed.
  */
-static char *print_string_ptr(const char *str) {
+static int print_string_ptr(const char *str, printbuffer *p) {
     const char *ptr;
-    char *ptr2, *out;
-    int len = 0;
+    char *ptr2;
+    size_t len = 0;
     unsigned char token;
 
     if (!str) {
-        return Json_strdup("");
+        return 1;
     }
 
     ptr = str;
@@ -381,12 +606,12 @@ static char *print_string_ptr(const char *str) {
         ptr++;
     }
 
-    out = (char *) Json_malloc(len + 3);
-    if (!out) {
+    ptr2 = ensure(p, len + 3);
+    if (!ptr2) {
         return 0;
     }
 
-    ptr2 = out;
+    p->offset += len + 2;
     ptr = str;
     *ptr2++ = '\"';
     while (*ptr) {
@@ -431,17 +656,16 @@ static char *print_string_ptr(const char *str) {
         }
     }
 
-    *ptr2++ = '\"';
-    *ptr2++ = 0;
+    *ptr2 = '\"';
 
-    return out;
+    return 1;
 }
 
 /*
  * Invote print_string_ptr (which is useful) on an item.
  */
-static char *print_string(Json *item) {
-    return print_string_ptr(item->valuestring);
+static int print_string(Json *item, printbuffer *p) {
+    return print_string_ptr(item->valuestring, p);
 }
 
 /*
@@ -455,148 +679,894 @@ static const char *skip(const char *in) {
 }
 
 /*
- * Parse an object - create a new root, and populate.
+ * Walks the structural index of a text, one token at a time.
  */
-Json *Json_Parse(const char *value) {
-    Json *c = Json_New_Item();
-    ep = 0;
-    if (!c) {
-        return 0; /* memory fail */
-    }
+typedef struct Json_Cursor {
+    const char *json;
+    const char *end;
+    const uint32 *positions;
+    size_t count;
+    size_t i;
+} Json_Cursor;
 
-    if (!parse_value(c, skip(value))) {
-        Json_Delete(c);
-        return 0;
-    }
-
-    return c;
-}
+static int parse_indexed_value(Json *item, Json_Cursor *cur);
 
 /*
- * Render a Json item/entity/structure to text.
+ * The current token, or 0 past the last one.
  */
-char *Json_Print(Json *item) {
-    return print_value(item, 0, 1);
-}
-
-char *Json_PrintUnformatted(Json *item) {
-    return print_value(item, 0, 0);
+static const char *cursor_peek(Json_Cursor *cur) {
+    return cur->i < cur->count ? cur->json + cur->positions[cur->i] : 0;
 }
 
 /*
- * Parser core - when encountering text, process appropriately.
+ * The opening quote is the current token and the closing quote the next one,
+ * so the length is known up front. Strings without escapes are a plain copy,
+ * the others go through parse_string.
  */
-static const char *parse_value(Json *item, const char *value) {
-    if (!value) {
-        return 0; /* Fail on null. */
-    }
-
-    if (!strncmp(value, "null", 4)) {
-        item->type = Json_NULL;
-        return value + 4;
-    }
-
-    if (!strncmp(value, "false", 5)) {
-        item->type = Json_False;
-        return value + 5;
-    }
-
-    if (!strncmp(value, "true", 4)) {
-        item->type = Json_True;
-        item->valueint = 1;
-        return value + 4;
-    }
+static int parse_indexed_string(Json *item, Json_Cursor *cur) {
+    const char *start, *end;
+    size_t len;
+    char *out;
 
-    if (*value == '\"') {
-        return parse_string(item, value);
+    if (cur->i + 1 >= cur->count) {
+        return 0;
     }
 
-    if (*value == '-' || (*value >= '0' && *value <= '9')) {
-        return parse_number(item, value);
+    start = cur->json + cur->positions[cur->i] + 1;
+    end = cur->json + cur->positions[cur->i + 1];
+    len = end - start;
+    if (*end != '\"') {
+        return 0;
     }
 
-    if (*value == '[') {
-        return parse_array(item, value);
-    }
+    if (memchr(start, '\\', len)) {
+        if (!parse_string(item, start - 1)) {
+            return 0;
+        }
+    } else {
+        out = (char *) parse_malloc(len + 1);
+        if (!out) {
+            return 0;
+        }
 
-    if (*value == '{') {
-        return parse_object(item, value);
+        memcpy(out, start, len);
+        out[len] = 0;
+        item->valuestring = out;
+        item->type = Json_String;
+        if (parse_arena) {
+            item->flags |= Json_BorrowedValueString;
+        }
     }
 
-    ep = value;
-    return 0; /* failure. */
+    cur->i += 2;
+    return 1;
 }
 
 /*
- * Render a value to text.
+ * Numbers, true, false and null are still parsed from the text, the index
+ * only tells where the next token starts.
  */
-static char *print_value(Json *item, int depth, int fmt) {
-    char *out = 0;
-    if (!item) {
+static int parse_indexed_scalar(Json *item, Json_Cursor *cur) {
+    const char *value = cursor_peek(cur);
+    const char *next;
+
+    if (*value == '-' || (*value >= '0' && *value <= '9')) {
+        value = parse_number(item, value);
+    } else {
+        value = parse_value(item, value);
+    }
+
+    cur->i++;
+    next = cursor_peek(cur);
+    if (!value || skip(value) != (next ? next : cur->end)) {
         return 0;
     }
 
-    switch ((item->type) & 255) {
-        case Json_NULL:
-            out = Json_strdup("null");
-            break;
+    return 1;
+}
 
-        case Json_False:
-            out = Json_strdup("false");
-            break;
+static int parse_indexed_array(Json *item, Json_Cursor *cur) {
+    Json *child = 0, *new_item;
+    const char *token;
 
-        case Json_True:
-            out = Json_strdup("true");
-            break;
+    item->type = Json_Array;
+    cur->i++;
+    token = cursor_peek(cur);
+    if (token && *token == ']') {
+        cur->i++;
+        return 1; /* empty array. */
+    }
 
-        case Json_Int:
-            out = print_int(item);
-            break;
+    while (1) {
+        if (!(new_item = Json_New_Item())) {
+            return 0; /* memory fail */
+        }
 
-        case Json_Double:
-            out = print_double(item);
-            break;
+        if (child) {
+            child->next = new_item;
+            new_item->prev = child;
+        } else {
+            item->child = new_item;
+        }
+        child = new_item;
 
-        case Json_String:
-            out = print_string(item);
-            break;
+        if (!parse_indexed_value(child, cur)) {
+            return 0;
+        }
 
-        case Json_Array:
-            out = print_array(item, depth, fmt);
-            break;
+        token = cursor_peek(cur);
+        if (!token) {
+            return 0;
+        }
 
-        case Json_Object:
-            out = print_object(item, depth, fmt);
-            break;
-    }
+        cur->i++;
+        if (*token == ']') {
+            return 1; /* end of array */
+        }
 
-    return out;
+        if (*token != ',') {
+            return 0; /* malformed. */
+        }
+    }
 }
 
 /*
- * Build an array from input text.
+ * The key is there between its quotes: an atom when it is interned and has no
+ * escape, a string of its own otherwise.
  */
-static const char *parse_array(Json *item, const char *value) {
-    Json *child;
-    if (*value != '[') {
-        ep = value;
-        return 0;
-    } /* not an array! */
-
-    item->type = Json_Array;
-    value = skip(value + 1);
-    if (*value == ']') {
-        return value + 1; /* empty array. */
+static int parse_indexed_key(Json *item, Json_Cursor *cur) {
+    const char *start, *end;
+
+    if (cur->i + 1 < cur->count) {
+        start = cur->json + cur->positions[cur->i] + 1;
+        end = cur->json + cur->positions[cur->i + 1];
+        if (*end == '\"' && !memchr(start, '\\', end - start) && atom_key(item, start, end - start)) {
+            cur->i += 2;
+            return 1;
+        }
     }
 
-    item->child = child = Json_New_Item();
-    if (!item->child) {
-        return 0; /* memory fail */
+    if (!parse_indexed_string(item, cur)) {
+        return 0;
     }
 
-    value = skip(parse_value(child, skip(value))); /* skip any spacing, get the value. */
-    if (!value) {
-        return 0;
+    move_key(item);
+    return 1;
+}
+
+static int parse_indexed_object(Json *item, Json_Cursor *cur) {
+    Json *child = 0, *new_item;
+    const char *token;
+
+    item->type = Json_Object;
+    cur->i++;
+    token = cursor_peek(cur);
+    if (token && *token == '}') {
+        cur->i++;
+        return 1; /* empty object. */
+    }
+
+    while (1) {
+        if (!(new_item = Json_New_Item())) {
+            return 0; /* memory fail */
+        }
+
+        if (child) {
+            child->next = new_item;
+            new_item->prev = child;
+        } else {
+            item->child = new_item;
+        }
+        child = new_item;
+
+        token = cursor_peek(cur);
+        if (!token || *token != '\"' || !parse_indexed_key(child, cur)) {
+            return 0;
+        }
+
+        token = cursor_peek(cur);
+        if (!token || *token != ':') {
+            return 0;
+        }
+
+        cur->i++;
+        if (!parse_indexed_value(child, cur)) {
+            return 0;
+        }
+
+        token = cursor_peek(cur);
+        if (!token) {
+            return 0;
+        }
+
+        cur->i++;
+        if (*token == '}') {
+            return 1; /* end of object */
+        }
+
+        if (*token != ',') {
+            return 0; /* malformed. */
+        }
+    }
+}
+
+static int parse_indexed_value(Json *item, Json_Cursor *cur) {
+    const char *token = cursor_peek(cur);
+    if (!token) {
+        return 0;
+    }
+
+    switch (*token) {
+        case '{':
+            return parse_indexed_object(item, cur);
+
+        case '[':
+            return parse_indexed_array(item, cur);
+
+        case '\"':
+            return parse_indexed_string(item, cur);
+
+        case '}':
+        case ']':
+        case ':':
+        case ',':
+            return 0;
+
+        default:
+            return parse_indexed_scalar(item, cur);
+    }
+}
+
+/*
+ * Json_Binary documents (json_binary.h) give the same tree as their text
+ * would. Strings carry their length, so they are plain copies.
+ */
+typedef struct Json_BinaryCursor {
+    const unsigned char *p;
+    const unsigned char *end;
+    int depth;
+} Json_BinaryCursor;
+
+static int parse_binary_value(Json *item, Json_BinaryCursor *cur);
+
+/*
+ * The head at p: its major type, -1 when malformed. The argument goes to
+ * *arg (JSON_BINARY_OPEN for an indefinite length), its size in bytes after
+ * the initial byte to *size.
+ */
+static int parse_binary_head(Json_BinaryCursor *cur, uint64 *arg, int *size) {
+    int info, major, i;
+
+    if (cur->p >= cur->end) {
+        return -1;
+    }
+
+    major = *cur->p >> 5;
+    info = *cur->p & 31;
+    *size = 0;
+    if (info < 24 || info == 31) {
+        *arg = info == 31 ? JSON_BINARY_OPEN : (uint64) info;
+        cur->p++;
+        return major;
+    }
+
+    if (info > 27) {
+        return -1;
+    }
+
+    *size = 1 << (info - 24);
+    if (cur->end - cur->p <= *size) {
+        return -1;
+    }
+
+    for (*arg = 0, i = 1; i <= *size; i++) {
+        *arg = *arg << 8 | cur->p[i];
+    }
+    cur->p += 1 + *size;
+
+    return major;
+}
+
+static int parse_binary_string(Json *item, Json_BinaryCursor *cur, uint64 len) {
+    char *out;
+
+    if (len == JSON_BINARY_OPEN || len > (uint64) (cur->end - cur->p)) {
+        return 0; /* chunked, or past the end */
+    }
+
+    if (!(out = (char *) parse_malloc((size_t) len + 1))) {
+        return 0;
+    }
+
+    memcpy(out, cur->p, (size_t) len);
+    out[len] = 0;
+    cur->p += len;
+    item->valuestring = out;
+    item->type = Json_String;
+    if (parse_arena) {
+        item->flags |= Json_BorrowedValueString;
+    }
+
+    return 1;
+}
+
+static int parse_binary_key(Json *item, Json_BinaryCursor *cur, uint64 len) {
+    if (len <= (uint64) (cur->end - cur->p) && atom_key(item, (const char *) cur->p, (size_t) len)) {
+        cur->p += len;
+        return 1;
+    }
+
+    if (!parse_binary_string(item, cur, len)) {
+        return 0;
+    }
+
+    move_key(item);
+    return 1;
+}
+
+/*
+ * count items, or pairs for an object, up to a break byte when it is
+ * JSON_BINARY_OPEN.
+ */
+static int parse_binary_container(Json *item, Json_BinaryCursor *cur, int type, uint64 count) {
+    Json *child = 0, *new_item;
+    uint64 len;
+    int size;
+
+    item->type = type;
+    if (++cur->depth > JSON_BINARY_MAX_DEPTH) {
+        return 0;
+    }
+
+    while (1) {
+        if (count == JSON_BINARY_OPEN) {
+            if (cur->p >= cur->end) {
+                return 0;
+            }
+            if (*cur->p == JSON_BINARY_BREAK) {
+                cur->p++;
+                break;
+            }
+        } else if (count-- == 0) {
+            break;
+        }
+
+        if (!(new_item = Json_New_Item())) {
+            return 0; /* memory fail */
+        }
+
+        if (child) {
+            child->next = new_item;
+            new_item->prev = child;
+        } else {
+            item->child = new_item;
+        }
+        child = new_item;
+
+        if (type == Json_Object) {
+            if (parse_binary_head(cur, &len, &size) != 3 || !parse_binary_key(child, cur, len)) {
+                return 0;
+            }
+        }
+
+        if (!parse_binary_value(child, cur)) {
+            return 0;
+        }
+    }
+
+    cur->depth--;
+    return 1;
+}
+
+static int parse_binary_value(Json *item, Json_BinaryCursor *cur) {
+    uint64 arg;
+    int major, size;
+
+    /* tags, the magic among them, say nothing the tree could keep */
+    while ((major = parse_binary_head(cur, &arg, &size)) == 6) {
+    }
+
+    switch (major) {
+        case 0:
+            item->type = Json_Int;
+            item->valueint = arg;
+            item->valuedouble = (double) arg;
+            item->sign = 1;
+            return 1;
+
+        case 1:
+            /* -1 - arg */
+            item->sign = -1;
+            if (arg > 9223372036854775807ULL) {
+                item->type = Json_Double;
+                item->valuedouble = -1.0 - (double) arg;
+                return 1;
+            }
+            item->type = Json_Int;
+            item->valueint = ~arg;
+            item->valuedouble = -1.0 - (double) arg;
+            return 1;
+
+        case 3:
+            return parse_binary_string(item, cur, arg);
+
+        case 4:
+            return parse_binary_container(item, cur, Json_Array, arg);
+
+        case 5:
+            return parse_binary_container(item, cur, Json_Object, arg);
+
+        case 7:
+            if (size >= 2) {
+                item->type = Json_Double;
+                item->valuedouble = Json_BinaryFloat(arg, size);
+                item->valueint = (item->valuedouble > -9223372036854775808.0
+                                  && item->valuedouble < 9223372036854775808.0)
+                                 ? (uint64) (int64) item->valuedouble : 0;
+                item->sign = 1;
+                return 1;
+            }
+
+            if (arg == 20 || arg == 21) {
+                item->type = arg == 21 ? Json_True : Json_False;
+                item->valueint = arg == 21;
+                return 1;
+            }
+
+            if (arg == 22 || arg == 23) {
+                item->type = Json_NULL; /* null, undefined */
+                return 1;
+            }
+            return 0;
+
+        default:
+            return 0; /* byte strings, or malformed */
+    }
+}
+
+Json *Json_ParseBinary(const char *data, size_t len) {
+    Json_BinaryCursor cur;
+    Json *c;
+
+    ep = 0;
+    if (!Json_IsBinary(data, len)) {
+        ep = data;
+        return 0;
+    }
+
+    if (!(c = Json_New_Item())) {
+        return 0; /* memory fail */
+    }
+
+    cur.p = (const unsigned char *) data;
+    cur.end = cur.p + len;
+    cur.depth = 0;
+    if (!parse_binary_value(c, &cur) || cur.p != cur.end) {
+        ep = (const char *) cur.p;
+        Json_Delete(c);
+        return 0;
+    }
+
+    return c;
+}
+
+Json *Json_ParseDescent(const char *value) {
+    Json *c = Json_New_Item();
+    ep = 0;
+    if (!c) {
+        return 0; /* memory fail */
+    }
+
+    if (!parse_value(c, skip(value))) {
+        Json_Delete(c);
+        return 0;
+    }
+
+    return c;
+}
+
+/*
+ * Parse an object - create a new root, and populate.
+ * Larger texts get a structural index first (see json_scan.h) and the tree
+ * is built by walking it. Anything the indexed walk rejects is handed to the
+ * recursive descent, which owns error reporting through ep.
+ */
+Json *Json_Parse(const char *value) {
+    Json_Index index;
+    Json_Cursor cur;
+    Json *c;
+    size_t len;
+    int ok;
+
+    if (!value || (len = strlen(value)) < JSON_SCAN_MIN_LENGTH) {
+        return Json_ParseDescent(value);
+    }
+
+    if (!Json_BuildIndex(value, len, &index)) {
+        Json_FreeIndex(&index);
+        return Json_ParseDescent(value);
+    }
+
+    c = Json_New_Item();
+    if (!c) {
+        Json_FreeIndex(&index);
+        return 0; /* memory fail */
+    }
+
+    cur.json = value;
+    cur.end = value + len;
+    cur.positions = index.positions;
+    cur.count = index.count;
+    cur.i = 0;
+    ep = 0;
+    ok = parse_indexed_value(c, &cur);
+    Json_FreeIndex(&index);
+    if (!ok) {
+        Json_Delete(c);
+        return Json_ParseDescent(value);
+    }
+
+    return c;
+}
+
+Json *Json_ParseInArena(const char *value, Json_Arena *arena) {
+    Json *c;
+    parse_arena = arena;
+    c = Json_Parse(value);
+    parse_arena = 0;
+
+    return c;
+}
+
+Json *Json_ParseInSitu(char *value) {
+    Json *c;
+    parse_insitu = 1;
+    c = Json_ParseDescent(value);
+    parse_insitu = 0;
+
+    return c;
+}
+
+const char *Json_ParseNumber(Json *item, const char *value) {
+    if (*value != '-' && (*value < '0' || *value > '9')) {
+        return 0;
+    }
+
+    return parse_number(item, value);
+}
+
+const char *Json_ParseStringInSitu(Json *item, char *value) {
+    const char *end;
+    parse_insitu = 1;
+    end = parse_string(item, value);
+    parse_insitu = 0;
+
+    return end;
+}
+
+Json *Json_ParseInSituInArena(char *value, Json_Arena *arena) {
+    Json *c;
+    parse_arena = arena;
+    c = Json_ParseInSitu(value);
+    parse_arena = 0;
+
+    return c;
+}
+
+/*
+ * Render a Json item/entity/structure to text.
+ */
+char *Json_Print(Json *item) {
+    return Json_PrintBuffered(item, JSON_PRINT_DEFAULT_BUFFER, 1);
+}
+
+char *Json_PrintUnformatted(Json *item) {
+    return Json_PrintBuffered(item, JSON_PRINT_DEFAULT_BUFFER, 0);
+}
+
+char *Json_PrintBuffered(Json *item, int prebuffer, int fmt) {
+    printbuffer p;
+    if (!item) {
+        return 0;
+    }
+
+    p.length = prebuffer > 0 ? (size_t) prebuffer : print_estimate(item, 0, fmt);
+    p.offset = 0;
+    p.buffer = (char *) Json_malloc(p.length);
+    if (!print_value(item, 0, fmt, &p) || !ensure(&p, 1)) {
+        if (p.buffer) {
+            Json_free(p.buffer);
+        }
+        return 0;
+    }
+
+    p.buffer[p.offset] = 0;
+
+    return p.buffer;
+}
+
+/*
+ * Parser core - when encountering text, process appropriately.
+ */
+static const char *parse_value(Json *item, const char *value) {
+    if (!value) {
+        return 0; /* Fail on null. */
+    }
+
+    if (!strncmp(value, "null", 4)) {
+        item->type = Json_NULL;
+        return value + 4;
+    }
+
+    if (!strncmp(value, "false", 5)) {
+        item->type = Json_False;
+        return value + 5;
+    }
+
+    if (!strncmp(value, "true", 4)) {
+        item->type = Json_True;
+        item->valueint = 1;
+        return value + 4;
+    }
+
+    if (*value == '\"') {
+        return parse_string(item, value);
+    }
+
+    if (*value == '-' || (*value >= '0' && *value <= '9')) {
+        return parse_number(item, value);
+    }
+
+    if (*value == '[') {
+        return parse_array(item, value);
+    }
+
+    if (*value == '{') {
+        return parse_object(item, value);
+    }
+
+    ep = value;
+    return 0; /* failure. */
+}
+
+/*
+ * Render a value to text.
+ */
+static int print_value(Json *item, int depth, int fmt, printbuffer *p) {
+    if (!item) {
+        return 0;
+    }
+
+    switch ((item->type) & 255) {
+        case Json_NULL:
+            return print_literal("null", 4, p);
+
+        case Json_False:
+            return print_literal("false", 5, p);
+
+        case Json_True:
+            return print_literal("true", 4, p);
+
+        case Json_Int:
+            return print_int(item, p);
+
+        case Json_Double:
+            return print_double(item, p);
+
+        case Json_String:
+            return print_string(item, p);
+
+        case Json_Array:
+            return print_array(item, depth, fmt, p);
+
+        case Json_Object:
+            return print_object(item, depth, fmt, p);
+    }
+
+    return 0;
+}
+
+static int print_literal(const char *str, size_t len, printbuffer *p) {
+    char *out = ensure(p, len);
+    if (!out) {
+        return 0;
+    }
+
+    memcpy(out, str, len);
+    p->offset += len;
+
+    return 1;
+}
+
+/*
+ * Roughly the printed size of item, for the buffer to start with: exact for
+ * the structure, keys and strings without escapes, an upper bound for numbers.
+ */
+static size_t print_estimate(Json *item, int depth, int fmt) {
+    size_t len;
+    Json *child;
+
+    switch ((item->type) & 255) {
+        case Json_Int:
+            return 21;
+
+        case Json_Double:
+            return 64;
+
+        case Json_String:
+            return item->valuestring ? strlen(item->valuestring) + 2 : 0;
+
+        case Json_Array:
+            len = 2;
+            for (child = item->child; child; child = child->next) {
+                len += print_estimate(child, depth + 1, fmt) + (fmt ? 2 : 1);
+            }
+            return len;
+
+        case Json_Object:
+            depth++;
+            len = fmt ? 3 + depth : 2;
+            for (child = item->child; child; child = child->next) {
+                len += (child->string ? strlen(child->string) + 2 : 0) + 2 + (fmt ? depth + 2 : 0);
+                len += print_estimate(child, depth, fmt);
+            }
+            return len;
+
+        default:
+            return 5;
+    }
+}
+
+/*
+ * Build an array from input text.
+ */
+static const char *parse_array(Json *item, const char *value) {
+    Json *child;
+    if (*value != '[') {
+        ep = value;
+        return 0;
+    } /* not an array! */
+
+    item->type = Json_Array;
+    value = skip(value + 1);
+    if (*value == ']') {
+        return value + 1; /* empty array. */
+    }
+
+    item->child = child = Json_New_Item();
+    if (!item->child) {
+        return 0; /* memory fail */
+    }
+
+    value = skip(parse_value(child, skip(value))); /* skip any spacing, get the value. */
+    if (!value) {
+        return 0;
+    }
+
+    while (*value == ',') {
+        Json *new_item;
+        if (!(new_item = Json_New_Item())) {
+            return 0; /* memory fail */
+        }
+
+        child->next = new_item;
+        new_item->prev = child;
+        child = new_item;
+        value = skip(parse_value(child, skip(value + 1)));
+        if (!value) {
+            return 0; /* memory fail */
+        }
+    }
+
+    if (*value == ']') {
+        return value + 1; /* end of array */
+    }
+
+    ep = value;
+    return 0; /* malformed. */
+}
+
+/*
+ * Render an array to text
+ */
+static int print_array(Json *item, int depth, int fmt, printbuffer *p) {
+    Json *child = item->child;
+    char *out = ensure(p, 1);
+    if (!out) {
+        return 0;
+    }
+
+    *out = '[';
+    p->offset++;
+    while (child) {
+        if (!print_value(child, depth + 1, fmt, p)) {
+            return 0;
+        }
+
+        child = child->next;
+        if (child) {
+            if (!(out = ensure(p, 2))) {
+                return 0;
+            }
+
+            *out++ = ',';
+            p->offset++;
+            if (fmt) {
+                *out = ' ';
+                p->offset++;
+            }
+        }
+    }
+
+    if (!(out = ensure(p, 1))) {
+        return 0;
+    }
+
+    *out = ']';
+    p->offset++;
+
+    return 1;
+}
+
+/*
+ * Build an object from the text.
+ */
+/*
+ * An object key: the atom when the text is interned and has no escape, a
+ * string of its own otherwise.
+ */
+static const char *parse_key(Json *item, const char *str) {
+    const char *end = str + 1;
+
+    if (*str == '\"') {
+        while (*end != '\"' && *end != '\\' && *end) {
+            end++;
+        }
+
+        if (*end == '\"' && atom_key(item, str + 1, end - str - 1)) {
+            return end + 1;
+        }
+    }
+
+    if (!(str = parse_string(item, str))) {
+        return 0;
+    }
+
+    move_key(item);
+    return str;
+}
+
+static const char *parse_object(Json *item, const char *value) {
+    Json *child;
+    if (*value != '{') {
+        ep = value;
+        return 0;
+    } /* not an object! */
+
+    item->type = Json_Object;
+    value = skip(value + 1);
+    if (*value == '}') {
+        return value + 1; /* empty array. */
+    }
+
+    item->child = child = Json_New_Item();
+    if (!item->child) {
+        return 0;
+    }
+
+    value = skip(parse_key(child, skip(value)));
+    if (!value) {
+        return 0;
+    }
+
+    if (*value != ':') {
+        ep = value;
+        return 0;
+    } /* fail! */
+
+    value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
+    if (!value) {
+        return 0;
     }
 
     while (*value == ',') {
@@ -608,328 +1578,601 @@ static const char *parse_array(Json *item, const char *value) {
         child->next = new_item;
         new_item->prev = child;
         child = new_item;
-        value = skip(parse_value(child, skip(value + 1)));
+        value = skip(parse_key(child, skip(value + 1)));
         if (!value) {
-            return 0; /* memory fail */
+            return 0;
+        }
+
+        if (*value != ':') {
+            ep = value;
+            return 0;
+        } /* fail! */
+
+        value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
+        if (!value) {
+            return 0;
         }
     }
 
-    if (*value == ']') {
+    if (*value == '}') {
         return value + 1; /* end of array */
     }
 
     ep = value;
+
     return 0; /* malformed. */
 }
 
 /*
- * Render an array to text
+ * A string checked the way parse_string reads it, nothing copied: returns
+ * the end of the string, or 0 with ep set where parse_string would fail.
  */
-static char *print_array(Json *item, int depth, int fmt) {
-    char **entries;
-    char *out = 0, *ptr, *ret;
-    int len = 5;
-    Json *child = item->child;
-    int numentries = 0, i = 0, fail = 0;
+static const char *skip_string(const char *str) {
+    const char *ptr = str + 1;
+    int code;
 
-    /*
-     * How many entries in the array?
-     */
-    while (child) {
-        numentries++, child = child->next;
+    while (*ptr != '\"' && *ptr) {
+        if (*ptr++ != '\\') {
+            continue;
+        }
+
+        if (!*ptr) {
+            ep = ptr;
+            return 0;
+        }
+
+        if (*ptr == 'u') {
+            if ((code = parse_hex4(ptr + 1)) < 0) {
+                ep = ptr - 1;
+                return 0;
+            }
+            ptr += 4;
+
+            /* the second half of a surrogate pair is read along with the first */
+            if (code >= 0xD800 && code <= 0xDBFF && ptr[1] == '\\' && ptr[2] == 'u') {
+                if (parse_hex4(ptr + 3) < 0) {
+                    ep = ptr + 1;
+                    return 0;
+                }
+                ptr += 6;
+            }
+        }
+        ptr++;
     }
 
-    /*
-     * Allocate an array to hold the values for each
-     */
-    entries = (char **) Json_malloc(numentries * sizeof(char *));
-    if (!entries) {
+    if (*ptr != '\"') {
+        ep = str;
         return 0;
     }
 
-    memset(entries, 0, numentries * sizeof(char *));
-    /*
-     * Retrieve all the results:
-     */
-    child = item->child;
-    while (child && !fail) {
-        ret = print_value(child, depth + 1, fmt);
-        entries[i++] = ret;
-        if (ret) {
-            len += strlen(ret) + 2 + (fmt ? 1 : 0);
-        } else {
-            fail = 1;
-        }
-        child = child->next;
+    return ptr + 1;
+}
+
+/*
+ * A value checked against the grammar parse_value accepts, nothing built:
+ * brackets matched, strings ended, numbers and literals read. Returns the end
+ * of the value, or 0 with ep set.
+ */
+static const char *skip_value(const char *value) {
+    Json number;
+    char close;
+
+    if (!value) {
+        return 0;
     }
 
-    /*
-     * If we didn't fail, try to malloc the output string
-     */
-    if (!fail) {
-        out = (char *) Json_malloc(len);
+    if (!strncmp(value, "null", 4) || !strncmp(value, "true", 4)) {
+        return value + 4;
     }
 
-    /*
-     * If that fails, we fail.
-     */
-    if (!out) {
-        fail = 1;
+    if (!strncmp(value, "false", 5)) {
+        return value + 5;
     }
 
-    /*
-     * Handle failure.
-     */
-    if (fail) {
-        for (i = 0; i < numentries; i++) {
-            if (entries[i]) {
-                Json_free(entries[i]);
+    if (*value == '\"') {
+        return skip_string(value);
+    }
+
+    if (*value == '-' || (*value >= '0' && *value <= '9')) {
+        return parse_number(&number, value);
+    }
+
+    if (*value != '[' && *value != '{') {
+        ep = value;
+        return 0;
+    }
+
+    close = *value == '[' ? ']' : '}';
+    value = skip(value + 1);
+    if (*value == close) {
+        return value + 1;
+    }
+
+    value = value - 1;
+    do {
+        value = skip(value + 1);
+        if (close == '}') {
+            if (*value != '\"') {
+                ep = value;
+                return 0;
+            }
+
+            value = skip(skip_string(value));
+            if (!value) {
+                return 0;
             }
+
+            if (*value != ':') {
+                ep = value;
+                return 0;
+            }
+            value = skip(value + 1);
+        }
+
+        value = skip(skip_value(value));
+        if (!value) {
+            return 0;
         }
+    } while (*value == ',');
 
-        Json_free(entries);
+    if (*value != close) {
+        ep = value;
         return 0;
     }
 
-    /*
-     * Compose the output array.
-     */
-    *out = '[';
-    ptr = out + 1;
-    *ptr = 0;
-    for (i = 0; i < numentries; i++) {
-        strcpy(ptr, entries[i]);
-        ptr += strlen(entries[i]);
-        if (i != numentries - 1) {
-            *ptr++ = ',';
-            if (fmt) {
-                *ptr++ = ' ';
-            }
-            *ptr = 0;
+    return value + 1;
+}
+
+/*
+ * Whether the key of len bytes at key is one of keys, case-insensitively.
+ */
+static int member_selected(const char *key, size_t len, const char *const *keys, int count) {
+    size_t i;
+    int k;
+
+    for (k = 0; k < count; k++) {
+        for (i = 0; i < len && keys[k][i] && tolower((unsigned char) key[i]) == tolower((unsigned char) keys[k][i]); i++) {
+        }
+
+        if (i == len && !keys[k][i]) {
+            return 1;
         }
-        Json_free(entries[i]);
     }
-    Json_free(entries);
-    *ptr++ = ']';
-    *ptr++ = 0;
 
-    return out;
+    return 0;
 }
 
 /*
- * Build an object from the text.
+ * The key at str, if it is one of keys, parsed into a new item: *member is
+ * that item, or 0 when the key is not selected. Returns the end of the key,
+ * 0 on error.
  */
-static const char *parse_object(Json *item, const char *value) {
+static const char *parse_member_key(Json **member, const char *str, const char *const *keys, int count) {
+    const char *end;
     Json *child;
-    if (*value != '{') {
-        ep = value;
+
+    *member = 0;
+    if (*str != '\"') {
+        ep = str;
         return 0;
-    } /* not an object! */
+    }
 
-    item->type = Json_Object;
-    value = skip(value + 1);
-    if (*value == '}') {
-        return value + 1; /* empty array. */
+    if (!(end = skip_string(str))) {
+        return 0;
     }
 
-    item->child = child = Json_New_Item();
-    if (!item->child) {
+    /* an escaped key is only known once unescaped */
+    if (!memchr(str, '\\', end - str) && !member_selected(str + 1, end - str - 2, keys, count)) {
+        return end;
+    }
+
+    if (!(child = Json_New_Item())) {
         return 0;
     }
 
-    value = skip(parse_string(child, skip(value)));
-    if (!value) {
+    if (!parse_key(child, str)) {
+        Json_Delete(child);
         return 0;
     }
 
-    child->string = child->valuestring;
-    child->valuestring = 0;
-    if (*value != ':') {
+    if (!member_selected(child->string, strlen(child->string), keys, count)) {
+        Json_Delete(child);
+        return end;
+    }
+
+    *member = child;
+    return end;
+}
+
+Json *Json_ParseMembers(const char *value, const char *const *keys, int count) {
+    Json *c, *member, *last = 0;
+
+    ep = 0;
+    value = skip(value);
+    if (!value || *value != '{') {
         ep = value;
         return 0;
-    } /* fail! */
+    }
+
+    if (!(c = Json_New_Item())) {
+        return 0; /* memory fail */
+    }
+
+    c->type = Json_Object;
+    value = skip(value + 1);
+    if (*value == '}') {
+        return c;
+    }
+
+    value = value - 1;
+    do {
+        value = skip(parse_member_key(&member, skip(value + 1), keys, count));
+        if (value && *value != ':') {
+            ep = value;
+            value = 0;
+        }
+
+        if (member) {
+            if (last) {
+                last->next = member;
+                member->prev = last;
+            } else {
+                c->child = member;
+            }
+            last = member;
+        }
+
+        if (value) {
+            value = skip(value + 1);
+            value = skip(member ? parse_value(member, value) : skip_value(value));
+        }
+    } while (value && *value == ',');
+
+    if (value && *value != '}') {
+        ep = value;
+        value = 0;
+    }
 
-    value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
     if (!value) {
+        Json_Delete(c);
         return 0;
     }
 
-    while (*value == ',') {
-        Json *new_item;
-        if (!(new_item = Json_New_Item())) {
-            return 0; /* memory fail */
+    return c;
+}
+
+Json *Json_ParseMembersInArena(const char *value, const char *const *keys, int count, Json_Arena *arena) {
+    Json *c;
+    parse_arena = arena;
+    c = Json_ParseMembers(value, keys, count);
+    parse_arena = 0;
+
+    return c;
+}
+
+/*
+ * Render an object to text.
+ */
+static int print_object(Json *item, int depth, int fmt, printbuffer *p) {
+    Json *child = item->child;
+    char *out = ensure(p, 2);
+    if (!out) {
+        return 0;
+    }
+
+    depth++;
+    *out++ = '{';
+    p->offset++;
+    if (fmt) {
+        *out = '\n';
+        p->offset++;
+    }
+
+    while (child) {
+        if (fmt) {
+            if (!(out = ensure(p, depth))) {
+                return 0;
+            }
+
+            memset(out, '\t', depth);
+            p->offset += depth;
         }
 
-        child->next = new_item;
-        new_item->prev = child;
-        child = new_item;
-        value = skip(parse_string(child, skip(value + 1)));
-        if (!value) {
+        if (!print_string_ptr(child->string, p) || !(out = ensure(p, 2))) {
             return 0;
         }
 
-        child->string = child->valuestring;
-        child->valuestring = 0;
-        if (*value != ':') {
-            ep = value;
+        *out++ = ':';
+        p->offset++;
+        if (fmt) {
+            *out = '\t';
+            p->offset++;
+        }
+
+        if (!print_value(child, depth, fmt, p) || !(out = ensure(p, 2))) {
             return 0;
-        } /* fail! */
+        }
+
+        child = child->next;
+        if (child) {
+            *out++ = ',';
+            p->offset++;
+        }
+
+        if (fmt) {
+            *out = '\n';
+            p->offset++;
+        }
+    }
+
+    if (!(out = ensure(p, depth + 1))) {
+        return 0;
+    }
+
+    if (fmt) {
+        memset(out, '\t', depth - 1);
+        out += depth - 1;
+        p->offset += depth - 1;
+    }
+
+    *out = '}';
+    p->offset++;
+
+    return 1;
+}
+
+/*
+ * Get Array size/item / object item.
+ */
+
+
+/*
+ * Open addressing table over the children of an object, in list order, so
+ * the first match along a probe sequence is also the first one in the list.
+ * The hash ignores case, the same table serves both kinds of lookup.
+ */
+typedef struct Json_KeySlot {
+    uint32 hash;
+    Json *item;
+} Json_KeySlot;
+
+struct Json_KeyIndex {
+    uint32 mask;
+    uint32 count;
+    Json_KeySlot slots[1];
+};
+
+struct Json_ArrayIndex {
+    uint32 count;
+    uint32 capacity;
+    Json *items[1];
+};
+
+static uint32 key_hash(const char *str) {
+    return Json_KeyHash(str, strlen(str));
+}
+
+/*
+ * An atom carries its hash.
+ */
+static uint32 item_hash(const Json *item) {
+    return (item->flags & Json_AtomString) ? Json_AtomHash(item->string) : key_hash(item->string);
+}
+
+/*
+ * The fold of the key of item when it is an atom, 0 otherwise.
+ */
+static const char *key_fold(const Json *item) {
+    return (item->flags & Json_AtomString) ? Json_AtomFold(item->string) : 0;
+}
 
-        value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
-        if (!value) {
-            return 0;
-        }
+/*
+ * c is named string. fold is set when string is an atom: keys that are atoms
+ * as well are the same key only as the same pointer, or the same fold.
+ */
+static int key_matches(const Json *c, const char *string, const char *fold, int case_sensitive) {
+    if (fold && (c->flags & Json_AtomString)) {
+        return case_sensitive ? c->string == string : Json_AtomFold(c->string) == fold;
     }
 
-    if (*value == '}') {
-        return value + 1; /* end of array */
+    if (!c->string) {
+        return 0;
     }
 
-    ep = value;
-
-    return 0; /* malformed. */
+    return case_sensitive ? !strcmp(c->string, string) : !Json_strcasecmp(c->string, string);
 }
 
 /*
- * Render an object to text.
+ * References share the children of another item, which can change behind
+ * their back: they never get a table.
  */
-static char *print_object(Json *item, int depth, int fmt) {
-    char **entries = 0, **names = 0;
-    char *out = 0, *ptr, *ret, *str;
-    int len = 7, i = 0, j;
-    Json *child = item->child;
-    int numentries = 0, fail = 0;
-    /*
-     * Count the number of entries.
-     */
-    while (child) {
-        numentries++, child = child->next;
-    }
+static Json_KeyIndex *key_index(Json *object) {
+    return object->type == Json_Object ? object->index.keys : 0;
+}
 
-    /* Allocate space for the names and the objects */
-    entries = (char **) Json_malloc(numentries * sizeof(char *));
-    if (!entries) {
-        return 0;
+static Json_ArrayIndex *array_index(Json *array) {
+    return array->type == Json_Array ? array->index.items : 0;
+}
+
+static void drop_index(Json *item) {
+    if (item->index.keys) {
+        Json_free(item->index.keys);
+        item->index.keys = 0;
     }
+}
 
-    names = (char **) Json_malloc(numentries * sizeof(char *));
-    if (!names) {
-        Json_free(entries);
-        return 0;
+static void index_insert(Json_KeyIndex *index, Json *item) {
+    uint32 hash = item_hash(item), i;
+    for (i = hash & index->mask; index->slots[i].item; i = (i + 1) & index->mask) {
     }
 
-    memset(entries, 0, sizeof(char *) * numentries);
-    memset(names, 0, sizeof(char *) * numentries);
+    index->slots[i].hash = hash;
+    index->slots[i].item = item;
+    index->count++;
+}
 
-    /* Collect all the results into our arrays: */
-    child = item->child;
-    depth++;
-    if (fmt) {
-        len += depth;
+static Json_ArrayIndex *new_array_index(uint32 capacity) {
+    Json_ArrayIndex *index = (Json_ArrayIndex *) Json_malloc(sizeof(Json_ArrayIndex) + (capacity - 1) * sizeof(Json *));
+    if (index) {
+        index->count = 0;
+        index->capacity = capacity;
     }
 
-    while (child) {
-        names[i] = str = print_string_ptr(child->string);
-        entries[i++] = ret = print_value(child, depth, fmt);
-        if (str && ret) {
-            len += strlen(ret) + strlen(str) + 2 + (fmt ? 2 + depth : 0);
-        } else {
-            fail = 1;
+    return index;
+}
+
+/*
+ * item was appended to the children: keep the table if it still has room,
+ * an array table doubles instead so that building an array stays linear.
+ */
+static void index_append(Json *item, Json *child) {
+    Json_KeyIndex *keys = key_index(item);
+    Json_ArrayIndex *items = array_index(item), *grown;
+
+    if (keys) {
+        if (!child->string || (keys->count + 1) * 2 > keys->mask + 1) {
+            drop_index(item);
+            return;
         }
-        child = child->next;
+
+        index_insert(keys, child);
+    } else if (items) {
+        if (items->count == items->capacity) {
+            grown = new_array_index(items->capacity * 2);
+            if (!grown) {
+                drop_index(item);
+                return;
+            }
+
+            memcpy(grown->items, items->items, items->count * sizeof(Json *));
+            grown->count = items->count;
+            Json_free(items);
+            item->index.items = items = grown;
+        }
+
+        items->items[items->count++] = child;
+    } else {
+        drop_index(item); /* a stale table left on a reference, or a changed type */
     }
+}
+
+static void build_index(Json *object) {
+    Json_KeyIndex *index;
+    Json *c;
+    uint32 size = 16, count = 0;
 
-    /* Try to allocate the output string */
-    if (!fail) {
-        out = (char *) Json_malloc(len);
+    for (c = object->child; c; c = c->next) {
+        count++;
     }
 
-    if (!out) {
-        fail = 1;
+    while (size < count * 2) {
+        size <<= 1;
     }
 
-    /* Handle failure */
-    if (fail) {
-        for (i = 0; i < numentries; i++) {
-            if (names[i]) {
-                Json_free(names[i]);
-            }
+    index = (Json_KeyIndex *) Json_malloc(sizeof(Json_KeyIndex) + (size - 1) * sizeof(Json_KeySlot));
+    if (!index) {
+        return; /* no index, lookups stay linear */
+    }
 
-            if (entries[i]) {
-                Json_free(entries[i]);
-            }
+    memset(index->slots, 0, size * sizeof(Json_KeySlot));
+    index->mask = size - 1;
+    index->count = 0;
+    for (c = object->child; c; c = c->next) {
+        if (c->string) {
+            index_insert(index, c);
         }
-        Json_free(names);
-        Json_free(entries);
-        return 0;
     }
 
-    /* Compose the output: */
-    *out = '{';
-    ptr = out + 1;
-    if (fmt) {
-        *ptr++ = '\n';
+    object->index.keys = index;
+}
+
+static void build_array_index(Json *array, uint32 count) {
+    Json_ArrayIndex *index;
+    Json *c;
+    uint32 capacity = JSON_ARRAY_INDEX_THRESHOLD;
+
+    while (capacity < count) {
+        capacity <<= 1;
     }
 
-    *ptr = 0;
-    for (i = 0; i < numentries; i++) {
-        if (fmt) {
-            for (j = 0; j < depth; j++) {
-                *ptr++ = '\t';
-            }
-        }
+    index = new_array_index(capacity);
+    if (!index) {
+        return; /* no table, accesses stay linear */
+    }
 
-        strcpy(ptr, names[i]);
-        ptr += strlen(names[i]);
-        *ptr++ = ':';
-        if (fmt) {
-            *ptr++ = '\t';
-        }
+    for (c = array->child; c; c = c->next) {
+        index->items[index->count++] = c;
+    }
 
-        strcpy(ptr, entries[i]);
-        ptr += strlen(entries[i]);
-        if (i != numentries - 1) {
-            *ptr++ = ',';
-        }
+    array->index.items = index;
+}
 
-        if (fmt) {
-            *ptr++ = '\n';
-        }
+int Json_Freeze(Json *item) {
+    Json *c;
+    uint32 count = 0;
 
-        *ptr = 0;
-        Json_free(names[i]);
-        Json_free(entries[i]);
+    if (item->type & Json_IsReference) {
+        return 1; /* no tables on references, what they share is frozen on its own */
     }
 
-    Json_free(names);
-    Json_free(entries);
-    if (fmt) {
-        for (i = 0; i < depth - 1; i++) {
-            *ptr++ = '\t';
+    for (c = item->child; c; c = c->next) {
+        if (!Json_Freeze(c)) {
+            return 0;
         }
+        count++;
+    }
+
+    /* the sizes at which find_item and Json_GetArraySize would build them */
+    if (item->index.keys) {
+        return 1;
     }
 
-    *ptr++ = '}';
-    *ptr++ = 0;
+    if (item->type == Json_Object && count >= JSON_KEY_INDEX_THRESHOLD) {
+        build_index(item);
+        return item->index.keys != 0;
+    }
+
+    if (item->type == Json_Array && count >= JSON_ARRAY_INDEX_THRESHOLD) {
+        build_array_index(item, count);
+        return item->index.items != 0;
+    }
 
-    return out;
+    return 1;
 }
 
-/*
- * Get Array size/item / object item.
- */
 int Json_GetArraySize(Json *array) {
+    Json_ArrayIndex *index = array_index(array);
     Json *c = array->child;
     int i = 0;
+
+    if (index) {
+        return (int) index->count;
+    }
+
     while (c) {
         i++, c = c->next;
     }
 
+    if (i >= JSON_ARRAY_INDEX_THRESHOLD && array->type == Json_Array) {
+        build_array_index(array, (uint32) i);
+    }
+
     return i;
 }
 
 Json *Json_GetArrayItem(Json *array, int item) {
+    Json_ArrayIndex *index = array_index(array);
     Json *c = array->child;
+
+    if (!index && item >= JSON_ARRAY_INDEX_THRESHOLD) {
+        Json_GetArraySize(array); /* builds the table if the array is that long */
+        index = array_index(array);
+    }
+
+    if (index && item >= 0) {
+        return (uint32) item < index->count ? index->items[item] : 0;
+    }
+
     while (c && item > 0) {
         item--, c = c->next;
     }
@@ -937,13 +2180,50 @@ Json *Json_GetArrayItem(Json *array, int item) {
     return c;
 }
 
-Json *Json_GetObjectItem(Json *object, const char *string) {
-    Json *c = object->child;
-    while (c && Json_strcasecmp(c->string, string)) {
-        c = c->next;
+/*
+ * fold is the fold of string when string is an atom, 0 otherwise.
+ */
+static Json *find_item(Json *object, const char *string, const char *fold, int case_sensitive) {
+    Json_KeyIndex *index = key_index(object);
+    Json_KeySlot *slot;
+    Json *c;
+    uint32 hash, i;
+    int visited = 0;
+
+    if (!index) {
+        for (c = object->child; c; c = c->next, visited++) {
+            if (key_matches(c, string, fold, case_sensitive)) {
+                break;
+            }
+        }
+
+        if (visited >= JSON_KEY_INDEX_THRESHOLD && object->type == Json_Object) {
+            build_index(object);
+        }
+
+        return c;
     }
 
-    return c;
+    hash = fold ? Json_AtomHash(string) : key_hash(string);
+    for (i = hash & index->mask; (slot = &index->slots[i])->item; i = (i + 1) & index->mask) {
+        if (slot->hash == hash && key_matches(slot->item, string, fold, case_sensitive)) {
+            return slot->item;
+        }
+    }
+
+    return 0;
+}
+
+Json *Json_GetObjectItem(Json *object, const char *string) {
+    return find_item(object, string, 0, 0);
+}
+
+Json *Json_GetObjectItemCaseSensitive(Json *object, const char *string) {
+    return find_item(object, string, 0, 1);
+}
+
+Json *Json_GetObjectItemByAtom(Json *object, const char *atom, int case_sensitive) {
+    return find_item(object, atom, Json_AtomFold(atom), case_sensitive);
 }
 
 /*
@@ -965,6 +2245,8 @@ static Json *create_reference(Json *item) {
 
     memcpy(ref, item, sizeof(Json));
     ref->string = 0;
+    ref->flags &= ~(Json_ArenaNode | Json_BorrowedString | Json_AtomString);
+    ref->index.keys = 0;
     ref->type |= Json_IsReference;
     ref->next = ref->prev = 0;
 
@@ -983,11 +2265,17 @@ void Json_AddItemToArray(Json *array, Json *item) {
     if (!c) {
         array->child = item;
     } else {
+        if (array_index(array) && array->index.items->count) {
+            c = array->index.items->items[array->index.items->count - 1];
+        }
+
         while (c && c->next) {
             c = c->next;
         }
         suffix_object(c, item);
     }
+
+    index_append(array, item);
 }
 
 void Json_AddItemToArrayHead(Json *array, Json *item) {
@@ -996,6 +2284,8 @@ void Json_AddItemToArrayHead(Json *array, Json *item) {
         return;
     }
 
+    drop_index(array);
+
     if (!c) {
         array->child = item;
     } else {
@@ -1011,11 +2301,7 @@ void Json_AddItemToObject(Json *object, const char *string, Json *item) {
         return;
     }
 
-    if (item->string) {
-        Json_free(item->string);
-    }
-
-    item->string = Json_strdup(string);
+    set_key(item, string);
     Json_AddItemToArray(object, item);
 }
 
@@ -1028,15 +2314,26 @@ void Json_AddItemReferenceToObject(Json *object, const char *string, Json *item)
 }
 
 Json *Json_DetachItemFromArray(Json *array, int which) {
-    Json *c = array->child;
-    while (c && which > 0) {
-        c = c->next, which--;
+    Json_ArrayIndex *index;
+    Json *c;
+
+    if (which < 0) {
+        which = 0;
     }
 
+    c = Json_GetArrayItem(array, which);
     if (!c) {
         return 0;
     }
 
+    index = array_index(array);
+    if (index) {
+        memmove(index->items + which, index->items + which + 1, (index->count - which - 1) * sizeof(Json *));
+        index->count--;
+    } else {
+        drop_index(array);
+    }
+
     if (c->prev) {
         c->prev->next = c->next;
     }
@@ -1080,15 +2377,23 @@ void Json_DeleteItemFromObject(Json *object, const char *string) {
  * Replace array/object items with new ones.
  */
 void Json_ReplaceItemInArray(Json *array, int which, Json *newitem) {
-    Json *c = array->child;
-    while (c && which > 0) {
-        c = c->next, which--;
+    Json *c;
+
+    if (which < 0) {
+        which = 0;
     }
 
+    c = Json_GetArrayItem(array, which);
     if (!c) {
         return;
     }
 
+    if (array_index(array)) {
+        array->index.items->items[which] = newitem;
+    } else {
+        drop_index(array);
+    }
+
     newitem->next = c->next;
     newitem->prev = c->prev;
     if (newitem->next) {
@@ -1113,7 +2418,7 @@ void Json_ReplaceItemInObject(Json *object, const char *string, Json *newitem) {
     }
 
     if (c) {
-        newitem->string = Json_strdup(string);
+        set_key(newitem, string);
         Json_ReplaceItemInArray(object, i, newitem);
     }
 }
@@ -1275,3 +2580,284 @@ Json *Json_CreateStringArray(const char **strings, int count) {
     return a;
 }
 
+Json *Json_Duplicate(Json *item, int recurse) {
+    Json *newitem, *child, *newchild, *tail = 0;
+    if (!item) {
+        return 0;
+    }
+
+    newitem = Json_New_Item();
+    if (!newitem) {
+        return 0; /* memory fail */
+    }
+
+    newitem->type = item->type & ~Json_IsReference;
+    newitem->valueint = item->valueint;
+    newitem->valuedouble = item->valuedouble;
+    newitem->sign = item->sign;
+    if (item->valuestring && !(newitem->valuestring = Json_strdup(item->valuestring))) {
+        Json_Delete(newitem);
+        return 0;
+    }
+
+    if (item->string && !set_key(newitem, item->string)) {
+        Json_Delete(newitem);
+        return 0;
+    }
+
+    if (!recurse) {
+        return newitem;
+    }
+
+    for (child = item->child; child; child = child->next) {
+        newchild = Json_Duplicate(child, 1);
+        if (!newchild) {
+            Json_Delete(newitem);
+            return 0;
+        }
+
+        if (tail) {
+            suffix_object(tail, newchild);
+        } else {
+            newitem->child = newchild;
+        }
+        tail = newchild;
+    }
+
+    return newitem;
+}
+
+/*
+ * Whether the integer is below 0: valueint read as signed for sign -1,
+ * unsigned otherwise, as it prints.
+ */
+static int int_negative(Json *item) {
+    return item->sign == -1 && (int64) item->valueint < 0;
+}
+
+/*
+ * The same number may be held signed on one side and unsigned on the other:
+ * the bits and the sign they stand for must both match.
+ */
+static int same_int(Json *a, Json *b) {
+    return a->valueint == b->valueint && int_negative(a) == int_negative(b);
+}
+
+int Json_Compare(Json *a, Json *b) {
+    Json *ca, *cb;
+    int type;
+
+    if (a == b) {
+        return 1;
+    }
+
+    if (!a || !b || (type = a->type & 255) != (b->type & 255)) {
+        return 0;
+    }
+
+    switch (type) {
+        case Json_Int:
+            return same_int(a, b);
+
+        case Json_Double:
+            return a->valuedouble == b->valuedouble;
+
+        case Json_String:
+            if (!a->valuestring || !b->valuestring) {
+                return a->valuestring == b->valuestring;
+            }
+            return !strcmp(a->valuestring, b->valuestring);
+
+        case Json_Array:
+        case Json_Object:
+            for (ca = a->child, cb = b->child; ca && cb; ca = ca->next, cb = cb->next) {
+                if (type == Json_Object && (!ca->string || !cb->string || strcmp(ca->string, cb->string))) {
+                    return 0;
+                }
+
+                if (!Json_Compare(ca, cb)) {
+                    return 0;
+                }
+            }
+
+            return !ca && !cb;
+
+        default:
+            return 1; /* false, true, null */
+    }
+}
+
+/*
+ * Drop the value of item, keeping its key and its place among its siblings:
+ * what it owned is freed, what it borrowed (from an arena, an in situ buffer,
+ * or the item it referenced) is let go.
+ */
+static void clear_value(Json *item) {
+    if (!(item->type & Json_IsReference)) {
+        Json_Delete(item->child);
+        if (item->valuestring && !(item->flags & Json_BorrowedValueString)) {
+            Json_free(item->valuestring);
+        }
+    }
+
+    drop_index(item);
+    item->child = 0;
+    item->valuestring = 0;
+    item->flags &= ~Json_BorrowedValueString;
+}
+
+/*
+ * item takes a copy of the value of value, in place.
+ */
+static int assign_value(Json *item, Json *value) {
+    Json *copy = Json_Duplicate(value, 1);
+    if (!copy) {
+        return 0;
+    }
+
+    clear_value(item);
+    item->type = copy->type;
+    item->valueint = copy->valueint;
+    item->valuedouble = copy->valuedouble;
+    item->sign = copy->sign;
+    item->valuestring = copy->valuestring;
+    item->child = copy->child;
+
+    copy->valuestring = 0;
+    copy->child = 0;
+    Json_Delete(copy);
+
+    return 1;
+}
+
+static void detach_member(Json *object, Json *item) {
+    drop_index(object);
+
+    if (item->prev) {
+        item->prev->next = item->next;
+    }
+
+    if (item->next) {
+        item->next->prev = item->prev;
+    }
+
+    if (item == object->child) {
+        object->child = item->next;
+    }
+
+    item->prev = item->next = 0;
+}
+
+int Json_MergePatch(Json *target, Json *patch, int case_sensitive) {
+    Json *member, *item;
+
+    if (!target || !patch) {
+        return 0;
+    }
+
+    /* values target already holds are left as they are, nothing is copied */
+    if ((patch->type & 255) != Json_Object) {
+        return Json_Compare(target, patch) || assign_value(target, patch);
+    }
+
+    /* a reference gets its own copy first, the patch must not write through to what it shares */
+    if ((target->type & Json_IsReference) && !assign_value(target, target)) {
+        return 0;
+    }
+
+    if (target->type != Json_Object) {
+        clear_value(target);
+        target->type = Json_Object;
+    }
+
+    for (member = patch->child; member; member = member->next) {
+        if (!member->string) {
+            continue;
+        }
+
+        item = find_item(target, member->string, key_fold(member), case_sensitive);
+        if ((member->type & 255) == Json_NULL) {
+            if (item) {
+                detach_member(target, item);
+                Json_Delete(item);
+            }
+            continue;
+        }
+
+        /* a new member is patched into an empty object: nulls deeper down are dropped */
+        if (!item) {
+            if (!(item = Json_CreateObject())) {
+                return 0;
+            }
+            Json_AddItemToObject(target, member->string, item);
+        }
+
+        if (!Json_MergePatch(item, member, case_sensitive)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+Json *Json_MergeDiff(Json *from, Json *to) {
+    Json *patch, *member, *item, *change;
+
+    if (!from || !to) {
+        return 0;
+    }
+
+    if ((from->type & 255) != Json_Object || (to->type & 255) != Json_Object) {
+        return Json_Duplicate(to, 1);
+    }
+
+    if (!(patch = Json_CreateObject())) {
+        return 0;
+    }
+
+    /*
+     * Removals first: a member whose key only changed case is then removed
+     * before it is added back, when the patch is applied case-insensitively.
+     */
+    for (member = from->child; member; member = member->next) {
+        if (!member->string || find_item(to, member->string, key_fold(member), 1)) {
+            continue;
+        }
+
+        if (!(change = Json_CreateNull())) {
+            Json_Delete(patch);
+            return 0;
+        }
+        Json_AddItemToObject(patch, member->string, change);
+    }
+
+    for (member = to->child; member; member = member->next) {
+        if (!member->string) {
+            continue;
+        }
+
+        item = find_item(from, member->string, key_fold(member), 1);
+        if (!item) {
+            change = Json_Duplicate(member, 1);
+        } else if (Json_Compare(item, member)) {
+            continue;
+        } else if ((item->type & 255) == Json_Object && (member->type & 255) == Json_Object) {
+            change = Json_MergeDiff(item, member);
+            if (change && !change->child) {
+                /* the same members in another order */
+                Json_Delete(change);
+                continue;
+            }
+        } else {
+            change = Json_Duplicate(member, 1);
+        }
+
+        if (!change) {
+            Json_Delete(patch);
+            return 0;
+        }
+        Json_AddItemToObject(patch, member->string, change);
+    }
+
+    return patch;
+}
@@ -34,6 +34,38 @@ typedef unsigned long long uint64;
 
 #define Json_IsReference 256
 
+/*
+ * An object gets a hashed key index once a lookup has to walk this many
+ * children, later lookups on it are O(1).
+ */
+#define JSON_KEY_INDEX_THRESHOLD 16
+
+/*
+ * Likewise an array gets an offset table once it is found to hold this many
+ * items, Json_GetArrayItem/Json_GetArraySize on it are O(1) from then on.
+ */
+#define JSON_ARRAY_INDEX_THRESHOLD 16
+
+/*
+ * Json_Print/Json_PrintUnformatted start with a buffer this size and double it
+ * whenever the text outgrows it.
+ */
+#define JSON_PRINT_DEFAULT_BUFFER 256
+
+/*
+ * Json flags: parts of the item Json_Delete won't free. They belong to a
+ * Json_Arena, or to the buffer given to Json_ParseInSitu.
+ */
+#define Json_ArenaNode 1
+#define Json_BorrowedValueString 2
+#define Json_BorrowedString 4
+
+/*
+ * The key is an atom (json_atom.h), always with Json_BorrowedString:
+ * lookups by atom match it by pointer.
+ */
+#define Json_AtomString 8
+
 /* The Json structure: */
 typedef struct Json {
     /*
@@ -48,11 +80,26 @@ typedef struct Json {
      */
     struct Json *child;
 
+    /*
+     * Lookup table over the children, built lazily by the accessors, kept
+     * up to date by appends and dropped on other changes to the children:
+     * the hashed key index of an object, the offset table of an array.
+     */
+    union {
+        struct Json_KeyIndex *keys;
+        struct Json_ArrayIndex *items;
+    } index;
+
     /*
      * The type of the item, as above.
      */
     int type;
 
+    /*
+     * Json_Arena* flags, 0 for items on the heap.
+     */
+    int flags;
+
     /*
      * The item's string, if type==Json_String
      */
@@ -98,6 +145,41 @@ extern void Json_InitHooks(Json_Hooks *hooks);
  */
 extern Json *Json_Parse(const char *value);
 
+/*
+ * Same as Json_Parse, but always with the byte-at-a-time recursive descent,
+ * never with the structural index.
+ */
+extern Json *Json_ParseDescent(const char *value);
+
+/*
+ * Destructive parse: strings and keys are unescaped in place inside value
+ * and valuestring/string point into it, so no string is copied.
+ * value must stay alive and untouched for as long as the result is in use.
+ * Always uses the recursive descent, a failed indexed walk could not fall
+ * back to a text it has already rewritten.
+ */
+extern Json *Json_ParseInSitu(char *value);
+
+/*
+ * Lazy parse of an object: only the members whose key is one of the count
+ * keys (matched case-insensitively, like Json_GetObjectItem) are built, in
+ * the order they come. The values of the other members are checked against
+ * the grammar and skipped, brackets matched and strings ended, with nothing
+ * allocated for them: a text Json_Parse rejects is rejected here too.
+ * Returns 0 on error, or when value is not an object.
+ */
+extern Json *Json_ParseMembers(const char *value, const char *const *keys, int count);
+
+/*
+ * Single token parsers, for readers that find the token boundaries themselves
+ * (json_reader.h). value must start with the number, or with the opening quote
+ * of the string, which is unescaped in place like Json_ParseInSitu does.
+ * Both fill item and return the end of the token, or 0 on error.
+ */
+extern const char *Json_ParseNumber(Json *item, const char *value);
+
+extern const char *Json_ParseStringInSitu(Json *item, char *value);
+
 /*
  * Render a Json entity to text for transfer/storage.
  * Free the char* when finished.
@@ -110,6 +192,14 @@ extern char *Json_Print(Json *item);
  */
 extern char *Json_PrintUnformatted(Json *item);
 
+/*
+ * Render a Json entity to text into one growing buffer, prebuffer is a guess
+ * at the final size: guessing well saves the copies as it grows. With
+ * prebuffer <= 0 the tree is walked once first to size it.
+ * fmt = 0 gives unformatted, = 1 gives formatted. Free the char* when finished.
+ */
+extern char *Json_PrintBuffered(Json *item, int prebuffer, int fmt);
+
 /*
  * Delete a Json entity and all subentities.
  */
@@ -132,6 +222,28 @@ extern Json *Json_GetArrayItem(Json *array, int item);
  */
 extern Json *Json_GetObjectItem(Json *object, const char *string);
 
+/*
+ * Get item "string" from object, exact match only.
+ */
+extern Json *Json_GetObjectItemCaseSensitive(Json *object, const char *string);
+
+/*
+ * Get item "atom" from object, atom from Json_Intern (json_atom.h).
+ * Keys that are atoms too are matched by pointer, only the others are
+ * compared as strings.
+ */
+extern Json *Json_GetObjectItemByAtom(Json *object, const char *atom, int case_sensitive);
+
+/*
+ * Build every lookup table that lookups would otherwise build on first use,
+ * down the whole tree. From then on reading the tree (lookups,
+ * Json_GetArrayItem/Json_GetArraySize, printing, comparing) never writes to
+ * it, so any number of threads may read it at once as long as none changes it.
+ * Returns 0 on memory fail: some tables are missing, the tree is not safe to
+ * share.
+ */
+extern int Json_Freeze(Json *item);
+
 /*
  * For analysing failed parses.
  * This returns a pointer to the parse error.
@@ -208,6 +320,45 @@ extern void Json_ReplaceItemInArray(Json *array, int which, Json *newitem);
 
 extern void Json_ReplaceItemInObject(Json *object, const char *string, Json *newitem);
 
+/*
+ * Deep copy of item (and its children when recurse is set), everything on
+ * the heap: the copy depends neither on an arena nor on an in situ buffer.
+ * A reference becomes an ordinary item. Returns 0 on memory fail.
+ */
+extern Json *Json_Duplicate(Json *item, int recurse);
+
+/*
+ * 1 if a and b hold the same data, 0 otherwise, stopping at the first
+ * difference. Members are compared in order with case-sensitive keys and
+ * numbers by value, which is what comparing the unformatted prints gave.
+ */
+extern int Json_Compare(Json *a, Json *b);
+
+/*
+ * JSON Merge Patch (RFC 7386), applied to target in place: a patch that is
+ * an object is merged member by member, null members delete the key and
+ * members new to target are appended; any other patch (an array, a scalar)
+ * replaces the value of target with a copy. target keeps its key and place
+ * in its parent, and items of target the patch does not touch keep their
+ * address. The patch is only read, what target takes from it is copied to
+ * the heap.
+ * Keys match like Json_GetObjectItem, unless case_sensitive is set (what
+ * RFC 7386 asks for).
+ * Returns 0 on memory fail, target is then patched only partway.
+ */
+extern int Json_MergePatch(Json *target, Json *patch, int case_sensitive);
+
+/*
+ * The merge patch that turns from into to: removed members as null,
+ * changed members as their new value (objects as a patch of their own),
+ * unchanged members left out; an empty object when the two hold the same
+ * members. Keys are compared case-sensitively.
+ * A merge patch cannot set a member to null, nulls in the objects of to
+ * come out deleted.
+ * Returns 0 on memory fail. Call Json_Delete when finished.
+ */
+extern Json *Json_MergeDiff(Json *from, Json *to);
+
 #define Json_AddNullToObject(object, name)        Json_AddItemToObject(object, name, Json_CreateNull())
 #define Json_AddTrueToObject(object, name)        Json_AddItemToObject(object, name, Json_CreateTrue())
 #define Json_AddFalseToObject(object, name)        Json_AddItemToObject(object, name, Json_CreateFalse())
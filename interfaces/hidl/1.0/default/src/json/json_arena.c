@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "json_arena.h"
+
+#define ARENA_ALIGN 8
+#define ALIGN_UP(n) (((n) + (ARENA_ALIGN - 1)) & ~((size_t) ARENA_ALIGN - 1))
+
+typedef struct Json_ArenaBlock {
+    struct Json_ArenaBlock *next;
+    size_t size;
+    size_t used;
+} Json_ArenaBlock;
+
+#define BLOCK_HEADER ALIGN_UP(sizeof(Json_ArenaBlock))
+#define BLOCK_DATA(b) ((char *) (b) + BLOCK_HEADER)
+
+struct Json_Arena {
+    /* current block first, older ones behind it */
+    Json_ArenaBlock *head;
+    size_t block_size;
+    Json_ArenaStats stats;
+};
+
+static Json_ArenaBlock *new_block(Json_Arena *arena, size_t size) {
+    Json_ArenaBlock *block = (Json_ArenaBlock *) malloc(BLOCK_HEADER + size);
+    if (!block) {
+        return 0;
+    }
+
+    block->next = 0;
+    block->size = size;
+    block->used = 0;
+    arena->stats.blocks++;
+    arena->stats.reserved += size;
+
+    return block;
+}
+
+static void free_blocks(Json_Arena *arena) {
+    Json_ArenaBlock *block = arena->head, *next;
+    while (block) {
+        next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->head = 0;
+    arena->stats.blocks = 0;
+    arena->stats.reserved = 0;
+}
+
+Json_Arena *Json_ArenaCreate(size_t block_size) {
+    Json_Arena *arena = (Json_Arena *) malloc(sizeof(Json_Arena));
+    if (!arena) {
+        return 0;
+    }
+
+    memset(arena, 0, sizeof(Json_Arena));
+    arena->block_size = ALIGN_UP(block_size ? block_size : JSON_ARENA_DEFAULT_BLOCK);
+
+    return arena;
+}
+
+void Json_ArenaDestroy(Json_Arena *arena) {
+    if (!arena) {
+        return;
+    }
+
+    free_blocks(arena);
+    free(arena);
+}
+
+void *Json_ArenaAlloc(Json_Arena *arena, size_t size) {
+    Json_ArenaBlock *block = arena->head;
+    void *ptr;
+
+    size = ALIGN_UP(size);
+    if (!block || block->size - block->used < size) {
+        block = new_block(arena, size > arena->block_size ? size : arena->block_size);
+        if (!block) {
+            return 0;
+        }
+
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    ptr = BLOCK_DATA(block) + block->used;
+    block->used += size;
+
+    arena->stats.used += size;
+    if (arena->stats.used > arena->stats.peak) {
+        arena->stats.peak = arena->stats.used;
+    }
+    arena->stats.allocations++;
+    arena->stats.total_allocations++;
+
+    return ptr;
+}
+
+void Json_ArenaReset(Json_Arena *arena) {
+    size_t used = arena->stats.used;
+
+    if (arena->stats.blocks > 1) {
+        /* The last document spilled: replace the chain with one block that fits it. */
+        arena->stats.spills++;
+        free_blocks(arena);
+        if (used > arena->block_size) {
+            arena->block_size = ALIGN_UP(used);
+        }
+        arena->head = new_block(arena, arena->block_size);
+    } else if (arena->head) {
+        arena->head->used = 0;
+    }
+
+    arena->stats.used = 0;
+    arena->stats.allocations = 0;
+    arena->stats.resets++;
+}
+
+void Json_ArenaGetStats(const Json_Arena *arena, Json_ArenaStats *stats) {
+    memcpy(stats, &arena->stats, sizeof(Json_ArenaStats));
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_ARENA_H_
+#define _JSON_ARENA_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+/*
+ * Default block size, enough for a full SceneState payload.
+ */
+#define JSON_ARENA_DEFAULT_BLOCK 4096
+
+/*
+ * A bump-pointer allocator for the nodes and strings of whole documents.
+ * Nothing is freed one by one, Json_ArenaReset drops everything at once.
+ */
+typedef struct Json_Arena Json_Arena;
+
+typedef struct Json_ArenaStats {
+    /* blocks currently owned, and their total capacity in bytes */
+    size_t blocks;
+    size_t reserved;
+
+    /* bytes handed out since the last reset, and the most ever seen */
+    size_t used;
+    size_t peak;
+
+    /* calls to Json_ArenaAlloc since the last reset, and in total */
+    size_t allocations;
+    size_t total_allocations;
+
+    /* number of resets, and how many of them had spilled past one block */
+    size_t resets;
+    size_t spills;
+} Json_ArenaStats;
+
+/*
+ * block_size 0 means JSON_ARENA_DEFAULT_BLOCK.
+ * Returns 0 on memory fail.
+ */
+extern Json_Arena *Json_ArenaCreate(size_t block_size);
+
+extern void Json_ArenaDestroy(Json_Arena *arena);
+
+/*
+ * 8-byte aligned, uninitialised. Returns 0 on memory fail.
+ */
+extern void *Json_ArenaAlloc(Json_Arena *arena, size_t size);
+
+/*
+ * Forget every allocation. The arena keeps a single block, grown to what the
+ * last document needed, so the next one of the same shape never hits malloc.
+ */
+extern void Json_ArenaReset(Json_Arena *arena);
+
+extern void Json_ArenaGetStats(const Json_Arena *arena, Json_ArenaStats *stats);
+
+/*
+ * Json_Parse with every node and string taken from arena.
+ * Json_Delete on the result only releases what was added later from the heap
+ * (edits, key indexes built by lookups), the document itself goes away with
+ * Json_ArenaReset/Json_ArenaDestroy, which must not happen while it is still
+ * in use.
+ */
+extern Json *Json_ParseInArena(const char *value, Json_Arena *arena);
+
+/*
+ * Json_ParseInSitu with the nodes taken from arena: strings live in value,
+ * everything else in arena, a parse does no malloc at all once the arena
+ * has grown to the document.
+ */
+extern Json *Json_ParseInSituInArena(char *value, Json_Arena *arena);
+
+/*
+ * Json_ParseMembers with every node and string taken from arena.
+ */
+extern Json *Json_ParseMembersInArena(const char *value, const char *const *keys, int count, Json_Arena *arena);
+
+#endif
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_atom.h"
+
+/*
+ * The text of an atom is what callers get, the rest sits in front of it.
+ */
+typedef struct Json_Atom {
+    const char *fold;
+    uint32 hash;
+    uint32 len;
+    char text[1];
+} Json_Atom;
+
+#define ATOM_OF(str) ((const Json_Atom *) ((str) - offsetof(Json_Atom, text)))
+
+#define ATOM_TABLE_MIN_SIZE 64
+
+/*
+ * Open addressing on the hash, kept at most half full. A table is never
+ * rehashed in place: a bigger one replaces it and the old one stays
+ * allocated, a reader may still be probing it.
+ */
+typedef struct Json_AtomTable {
+    struct Json_AtomTable *previous;
+    uint32 mask;
+    uint32 count;
+    uint32 longest; /* longer texts are not looked for */
+    Json_Atom *slots[1];
+} Json_AtomTable;
+
+/* read without the lock: loads acquire, stores (under the lock) release */
+static Json_AtomTable *atoms;
+
+static pthread_mutex_t atoms_lock = PTHREAD_MUTEX_INITIALIZER;
+
+uint32 Json_KeyHash(const char *str, size_t len) {
+    uint32 hash = 2166136261u;
+    unsigned char c;
+    while (len--) {
+        c = (unsigned char) *str++;
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ c) * 16777619u;
+    }
+
+    return hash;
+}
+
+static const Json_Atom *find_atom(const Json_AtomTable *table, const char *str, size_t len, uint32 hash) {
+    const Json_Atom *atom;
+    uint32 i;
+
+    for (i = hash & table->mask; (atom = __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE)); i = (i + 1) & table->mask) {
+        if (atom->hash == hash && atom->len == len && !memcmp(atom->text, str, len)) {
+            return atom;
+        }
+    }
+
+    return 0;
+}
+
+const char *Json_AtomFind(const char *str, size_t len) {
+    const Json_AtomTable *table = __atomic_load_n(&atoms, __ATOMIC_ACQUIRE);
+    const Json_Atom *atom;
+
+    if (!table || len > __atomic_load_n(&table->longest, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+
+    atom = find_atom(table, str, len, Json_KeyHash(str, len));
+    return atom ? atom->text : 0;
+}
+
+static void put_atom(Json_AtomTable *table, Json_Atom *atom) {
+    uint32 i;
+    for (i = atom->hash & table->mask; table->slots[i]; i = (i + 1) & table->mask) {
+    }
+
+    __atomic_store_n(&table->slots[i], atom, __ATOMIC_RELEASE);
+    __atomic_store_n(&table->count, table->count + 1, __ATOMIC_RELAXED);
+    if (atom->len > table->longest) {
+        __atomic_store_n(&table->longest, atom->len, __ATOMIC_RELAXED);
+    }
+}
+
+/*
+ * Room for one more atom in the current table. Called with the lock held.
+ */
+static Json_AtomTable *reserve_atom() {
+    Json_AtomTable *table = atoms, *grown;
+    uint32 size = ATOM_TABLE_MIN_SIZE, i;
+
+    if (table && (table->count + 1) * 2 <= table->mask + 1) {
+        return table;
+    }
+
+    if (table) {
+        size = (table->mask + 1) * 2;
+    }
+
+    grown = (Json_AtomTable *) malloc(sizeof(Json_AtomTable) + (size - 1) * sizeof(Json_Atom *));
+    if (!grown) {
+        return 0;
+    }
+
+    memset(grown->slots, 0, size * sizeof(Json_Atom *));
+    grown->previous = table;
+    grown->mask = size - 1;
+    grown->count = 0;
+    grown->longest = 0;
+    for (i = 0; table && i <= table->mask; i++) {
+        if (table->slots[i]) {
+            put_atom(grown, table->slots[i]);
+        }
+    }
+
+    __atomic_store_n(&atoms, grown, __ATOMIC_RELEASE);
+    return grown;
+}
+
+/*
+ * Called with the lock held. The lower case spelling goes in first, it is
+ * the fold of the others.
+ */
+static const Json_Atom *intern_atom(const char *str, size_t len) {
+    const Json_Atom *fold = 0;
+    Json_AtomTable *table = atoms;
+    Json_Atom *atom;
+    uint32 hash = Json_KeyHash(str, len);
+    char *lower;
+    size_t i;
+
+    if (table && (fold = find_atom(table, str, len, hash))) {
+        return fold;
+    }
+
+    for (i = 0; i < len && !(str[i] >= 'A' && str[i] <= 'Z'); i++) {
+    }
+
+    if (i < len) {
+        if (!(lower = (char *) malloc(len))) {
+            return 0;
+        }
+
+        for (i = 0; i < len; i++) {
+            lower[i] = (str[i] >= 'A' && str[i] <= 'Z') ? str[i] + 'a' - 'A' : str[i];
+        }
+
+        fold = intern_atom(lower, len);
+        free(lower);
+        if (!fold) {
+            return 0;
+        }
+    }
+
+    if (!(table = reserve_atom()) || !(atom = (Json_Atom *) malloc(offsetof(Json_Atom, text) + len + 1))) {
+        return 0;
+    }
+
+    memcpy(atom->text, str, len);
+    atom->text[len] = 0;
+    atom->fold = fold ? fold->text : atom->text;
+    atom->hash = hash;
+    atom->len = (uint32) len;
+    put_atom(table, atom);
+
+    return atom;
+}
+
+const char *Json_Intern(const char *str) {
+    const char *found = Json_AtomFind(str, strlen(str));
+    const Json_Atom *atom;
+
+    if (found) {
+        return found;
+    }
+
+    pthread_mutex_lock(&atoms_lock);
+    atom = intern_atom(str, strlen(str));
+    pthread_mutex_unlock(&atoms_lock);
+
+    return atom ? atom->text : 0;
+}
+
+const char *Json_AtomFold(const char *atom) {
+    return ATOM_OF(atom)->fold;
+}
+
+uint32 Json_AtomHash(const char *atom) {
+    return ATOM_OF(atom)->hash;
+}
+
+size_t Json_AtomCount() {
+    const Json_AtomTable *table = __atomic_load_n(&atoms, __ATOMIC_ACQUIRE);
+    return table ? __atomic_load_n(&table->count, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_ATOM_H_
+#define _JSON_ATOM_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+/*
+ * Interned keys. An atom is the one copy of its text the process keeps, the
+ * same pointer for every caller, never freed. The parsers take the keys of
+ * objects from here whenever the text is already interned: no copy, and the
+ * item is flagged Json_AtomString. Lookups by atom
+ * (Json_GetObjectItemByAtom) then compare pointers, not strings.
+ *
+ * The table is meant for a small, fixed vocabulary ("app", "packageName",
+ * "cpu", ...), interned once at start up: nothing is ever taken out of it.
+ * Interning is safe from any thread, finding never blocks.
+ */
+
+/*
+ * The atom for the text str, interned now if it was not yet.
+ * Returns 0 on memory fail.
+ */
+extern const char *Json_Intern(const char *str);
+
+/*
+ * The atom for the len bytes at str, 0 when they were never interned.
+ */
+extern const char *Json_AtomFind(const char *str, size_t len);
+
+/*
+ * The atom of the same text in lower case: two atoms match case-insensitively
+ * when their folds are the same pointer. atom must come from this table.
+ */
+extern const char *Json_AtomFold(const char *atom);
+
+/*
+ * Hash of len bytes at str, the same for every case of the text: what the
+ * key indexes of objects are built on. Each atom keeps its own.
+ */
+extern uint32 Json_KeyHash(const char *str, size_t len);
+
+extern uint32 Json_AtomHash(const char *atom);
+
+/*
+ * Number of atoms interned so far.
+ */
+extern size_t Json_AtomCount();
+
+#endif
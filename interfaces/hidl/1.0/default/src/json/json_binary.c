@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "json_binary.h"
+
+int Json_IsBinary(const char *data, size_t len) {
+    return len >= JSON_BINARY_MAGIC_LEN && !memcmp(data, JSON_BINARY_MAGIC, JSON_BINARY_MAGIC_LEN);
+}
+
+double Json_BinaryFloat(uint64 bits, int size) {
+    union {
+        float f;
+        uint32 u;
+    } f32;
+    union {
+        double d;
+        uint64 u;
+    } f64;
+    double half;
+    int exponent;
+
+    switch (size) {
+        case 2:
+            exponent = (int) (bits >> 10) & 31;
+            if (exponent == 31) {
+                half = (bits & 1023) ? NAN : INFINITY;
+            } else if (exponent == 0) {
+                half = ldexp((double) (bits & 1023), -24);
+            } else {
+                half = ldexp((double) ((bits & 1023) | 1024), exponent - 25);
+            }
+            return (bits & 0x8000) ? -half : half;
+
+        case 4:
+            f32.u = (uint32) bits;
+            return f32.f;
+
+        default:
+            f64.u = bits;
+            return f64.d;
+    }
+}
+
+int Json_BinaryHead(int major, uint64 arg, char *out) {
+    int size, i;
+
+    if (arg < 24) {
+        out[0] = (char) (major << 5 | (int) arg);
+        return 1;
+    }
+
+    size = arg <= 0xff ? 1 : arg <= 0xffff ? 2 : arg <= 0xffffffffULL ? 4 : 8;
+    out[0] = (char) (major << 5 | (size == 1 ? 24 : size == 2 ? 25 : size == 4 ? 26 : 27));
+    for (i = size; i > 0; i--, arg >>= 8) {
+        out[i] = (char) (arg & 0xff);
+    }
+
+    return 1 + size;
+}
+
+int Json_BinaryInt(uint64 magnitude, int negative, char *out) {
+    if (negative && magnitude) {
+        return Json_BinaryHead(1, magnitude - 1, out);
+    }
+
+    return Json_BinaryHead(0, magnitude, out);
+}
+
+int Json_BinaryDouble(double value, char *out) {
+    union {
+        float f;
+        uint32 u;
+    } f32;
+    union {
+        double d;
+        uint64 u;
+    } f64;
+    int i;
+
+    if (value != value || value - value != 0) {
+        out[0] = (char) 0xf6;
+        return 1;
+    }
+
+    f32.f = (float) value;
+    if ((double) f32.f == value) {
+        out[0] = (char) 0xfa;
+        for (i = 4; i > 0; i--, f32.u >>= 8) {
+            out[i] = (char) (f32.u & 0xff);
+        }
+        return 5;
+    }
+
+    f64.d = value;
+    out[0] = (char) 0xfb;
+    for (i = 8; i > 0; i--, f64.u >>= 8) {
+        out[i] = (char) (f64.u & 0xff);
+    }
+
+    return 9;
+}
+
+typedef struct {
+    char *buffer;
+    size_t length;
+    size_t offset;
+} binarybuffer;
+
+/*
+ * Room for needed more bytes at offset, growing the buffer twofold.
+ */
+static char *ensure(binarybuffer *p, size_t needed) {
+    char *newbuffer;
+    size_t newsize;
+
+    needed += p->offset;
+    if (needed <= p->length) {
+        return p->buffer + p->offset;
+    }
+
+    for (newsize = p->length ? p->length : 64; newsize < needed; newsize *= 2) {
+    }
+
+    if (!(newbuffer = (char *) realloc(p->buffer, newsize))) {
+        return 0;
+    }
+
+    p->buffer = newbuffer;
+    p->length = newsize;
+
+    return newbuffer + p->offset;
+}
+
+static int write_text(binarybuffer *p, const char *text) {
+    size_t len = strlen(text);
+    char *out = ensure(p, JSON_BINARY_HEAD_MAX + len);
+    if (!out) {
+        return 0;
+    }
+
+    p->offset += Json_BinaryHead(3, len, out);
+    memcpy(p->buffer + p->offset, text, len);
+    p->offset += len;
+
+    return 1;
+}
+
+static int write_value(Json *item, binarybuffer *p) {
+    char *out = ensure(p, JSON_BINARY_HEAD_MAX);
+    Json *child;
+    int count;
+
+    if (!out) {
+        return 0;
+    }
+
+    switch ((item->type) & 255) {
+        case Json_NULL:
+            *out = (char) 0xf6;
+            p->offset++;
+            return 1;
+
+        case Json_False:
+            *out = (char) 0xf4;
+            p->offset++;
+            return 1;
+
+        case Json_True:
+            *out = (char) 0xf5;
+            p->offset++;
+            return 1;
+
+        case Json_Int:
+            if (item->sign == -1 && (int64) item->valueint < 0) {
+                p->offset += Json_BinaryInt(0 - item->valueint, 1, out);
+            } else {
+                p->offset += Json_BinaryInt(item->valueint, 0, out);
+            }
+            return 1;
+
+        case Json_Double:
+            p->offset += Json_BinaryDouble(item->valuedouble, out);
+            return 1;
+
+        case Json_String:
+            return write_text(p, item->valuestring ? item->valuestring : "");
+
+        case Json_Array:
+        case Json_Object:
+            for (count = 0, child = item->child; child; child = child->next) {
+                count++;
+            }
+            p->offset += Json_BinaryHead((item->type & 255) == Json_Array ? 4 : 5, count, out);
+
+            for (child = item->child; child; child = child->next) {
+                if ((item->type & 255) == Json_Object && !write_text(p, child->string ? child->string : "")) {
+                    return 0;
+                }
+                if (!write_value(child, p)) {
+                    return 0;
+                }
+            }
+            return 1;
+    }
+
+    return 0;
+}
+
+char *Json_PrintBinary(Json *item, size_t *len) {
+    binarybuffer p = {0, 0, 0};
+
+    if (!ensure(&p, JSON_BINARY_MAGIC_LEN)) {
+        return 0;
+    }
+
+    memcpy(p.buffer, JSON_BINARY_MAGIC, JSON_BINARY_MAGIC_LEN);
+    p.offset = JSON_BINARY_MAGIC_LEN;
+    if (!write_value(item, &p)) {
+        free(p.buffer);
+        return 0;
+    }
+
+    *len = p.offset;
+
+    return p.buffer;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_BINARY_H_
+#define _JSON_BINARY_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+/*
+ * Json_Binary: the subset of CBOR (RFC 8949) that maps onto a Json tree,
+ * for senders that would rather not format and parse text:
+ *
+ *     major 0, 1    integers, Json_Int
+ *     major 3       text strings, keys of maps must be text strings too
+ *     major 4, 5    arrays and maps, definite or indefinite length
+ *     major 6       tags, skipped
+ *     major 7       false, true, null (undefined reads as null) and
+ *                   half, single and double floats, Json_Double
+ *
+ * Byte strings and chunked text strings are rejected.
+ * A document starts with the self-described CBOR tag (0xd9 0xd9 0xf7),
+ * which no text JSON can start with: that is how Json_Reader, and the
+ * scene status of notifySceneChangedBinary, tell the two apart.
+ */
+#define JSON_BINARY_MAGIC "\xd9\xd9\xf7"
+#define JSON_BINARY_MAGIC_LEN 3
+
+/* Longest head: the initial byte and a 64 bit argument. */
+#define JSON_BINARY_HEAD_MAX 9
+
+/* Objects and arrays nested deeper than this are an error. */
+#define JSON_BINARY_MAX_DEPTH 64
+
+/* Heads of indefinite length arrays and maps, and the byte that ends them. */
+#define JSON_BINARY_OPEN (~0ULL)
+#define JSON_BINARY_START_ARRAY 0x9f
+#define JSON_BINARY_START_MAP 0xbf
+#define JSON_BINARY_BREAK 0xff
+
+/*
+ * 1 if data starts with JSON_BINARY_MAGIC.
+ */
+extern int Json_IsBinary(const char *data, size_t len);
+
+/*
+ * Decode a Json_Binary document into a tree on the heap, the same tree
+ * Json_Parse gives for the same data. Returns 0 on error, with
+ * Json_GetErrorPtr at the byte that failed. Call Json_Delete when finished.
+ */
+extern Json *Json_ParseBinary(const char *data, size_t len);
+
+/*
+ * Encode a Json entity as a Json_Binary document, magic included. Doubles
+ * are written as single floats when that is exact. NaN and infinities are
+ * written as null, like the text printer does.
+ * Returns the document and its size in *len, 0 on memory fail.
+ * Free the char* when finished.
+ */
+extern char *Json_PrintBinary(Json *item, size_t *len);
+
+/*
+ * Building blocks for other encoders (JsonBinding): each writes one item
+ * into out, which must hold JSON_BINARY_HEAD_MAX bytes, and returns the
+ * number of bytes written.
+ * A head of major type 0-7 with its argument: for a text string its length
+ * in bytes, the bytes follow; for an array or a map its count of items or
+ * pairs.
+ */
+extern int Json_BinaryHead(int major, uint64 arg, char *out);
+
+/*
+ * The integer -magnitude when negative is set, magnitude otherwise.
+ */
+extern int Json_BinaryInt(uint64 magnitude, int negative, char *out);
+
+extern int Json_BinaryDouble(double value, char *out);
+
+/*
+ * The value of a half (size 2), single (4) or double (8) float argument.
+ */
+extern double Json_BinaryFloat(uint64 bits, int size);
+
+#endif
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <strings.h>
+#include <new>
+
+#include "json_binding.h"
+#include "json_view.h"
+
+extern "C" {
+#include "json_number.h"
+}
+
+// The scalar of the next event, NULL when it is an object or an array (skipped)
+// or the reader failed.
+static const Json *NextScalar(Json_Reader *pReader) {
+    int event = Json_ReaderNext(pReader);
+    if (event == Json_EventValue) {
+        return (Json_ReaderItem(pReader));
+    }
+
+    if (event == Json_EventStartObject || event == Json_EventStartArray) {
+        Json_ReaderSkip(pReader);
+    }
+    return (NULL);
+}
+
+template<class V>
+static bool DecodeScalar(Json_Reader *pReader, V &value) {
+    const Json *pItem = NextScalar(pReader);
+    if (pItem != NULL) {
+        JsonView::ToValue(pItem, value);
+    }
+
+    return (Json_ReaderGetError(pReader, NULL) == NULL);
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, std::string &strValue) {
+    return (DecodeScalar(pReader, strValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, int32 &iValue) {
+    return (DecodeScalar(pReader, iValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, uint32 &uiValue) {
+    return (DecodeScalar(pReader, uiValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, int64 &llValue) {
+    return (DecodeScalar(pReader, llValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, uint64 &ullValue) {
+    return (DecodeScalar(pReader, ullValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, bool &bValue) {
+    return (DecodeScalar(pReader, bValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, float &fValue) {
+    return (DecodeScalar(pReader, fValue));
+}
+
+bool JsonBinding::DecodeValue(Json_Reader *pReader, double &dValue) {
+    return (DecodeScalar(pReader, dValue));
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, std::string &strValue) {
+    JsonView::ToValue(pItem, strValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, int32 &iValue) {
+    JsonView::ToValue(pItem, iValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, uint32 &uiValue) {
+    JsonView::ToValue(pItem, uiValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, int64 &llValue) {
+    JsonView::ToValue(pItem, llValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, uint64 &ullValue) {
+    JsonView::ToValue(pItem, ullValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, bool &bValue) {
+    JsonView::ToValue(pItem, bValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, float &fValue) {
+    JsonView::ToValue(pItem, fValue);
+    return (true);
+}
+
+bool JsonBinding::DecodeValue(const Json *pItem, double &dValue) {
+    JsonView::ToValue(pItem, dValue);
+    return (true);
+}
+
+void JsonBinding::EncodeValue(const std::string &strValue, std::string &strOut) {
+    EncodeString(strValue.c_str(), strOut);
+}
+
+void JsonBinding::EncodeValue(int32 iValue, std::string &strOut) {
+    char szNumber[16];
+    snprintf(szNumber, sizeof(szNumber), "%d", iValue);
+    strOut += szNumber;
+}
+
+void JsonBinding::EncodeValue(uint32 uiValue, std::string &strOut) {
+    char szNumber[16];
+    snprintf(szNumber, sizeof(szNumber), "%u", uiValue);
+    strOut += szNumber;
+}
+
+void JsonBinding::EncodeValue(int64 llValue, std::string &strOut) {
+    char szNumber[JSON_NUMBER_BUFFER];
+    strOut.append(szNumber, Json_FormatUint64(llValue < 0 ? 0 - (uint64) llValue : (uint64) llValue, llValue < 0,
+                                              szNumber));
+}
+
+void JsonBinding::EncodeValue(uint64 ullValue, std::string &strOut) {
+    char szNumber[JSON_NUMBER_BUFFER];
+    strOut.append(szNumber, Json_FormatUint64(ullValue, 0, szNumber));
+}
+
+void JsonBinding::EncodeValue(bool bValue, std::string &strOut) {
+    strOut += bValue ? "true" : "false";
+}
+
+void JsonBinding::EncodeValue(float fValue, std::string &strOut) {
+    EncodeValue((double) fValue, strOut);
+}
+
+void JsonBinding::EncodeValue(double dValue, std::string &strOut) {
+    // shortest form that reads back as dValue, null for nan and inf
+    char szNumber[JSON_NUMBER_BUFFER];
+    strOut.append(szNumber, Json_FormatDouble(dValue, szNumber));
+}
+
+void JsonBinding::EncodeString(const char *szValue, std::string &strOut) {
+    static const char *HEX = "0123456789abcdef";
+
+    strOut += '\"';
+    for (const char *p = szValue; *p; ++p) {
+        unsigned char c = (unsigned char) *p;
+        switch (c) {
+            case '\"':
+                strOut += "\\\"";
+                break;
+            case '\\':
+                strOut += "\\\\";
+                break;
+            case '\b':
+                strOut += "\\b";
+                break;
+            case '\f':
+                strOut += "\\f";
+                break;
+            case '\n':
+                strOut += "\\n";
+                break;
+            case '\r':
+                strOut += "\\r";
+                break;
+            case '\t':
+                strOut += "\\t";
+                break;
+            default:
+                if (c < 32) {
+                    strOut += "\\u00";
+                    strOut += HEX[c >> 4];
+                    strOut += HEX[c & 15];
+                } else {
+                    strOut += (char) c;
+                }
+                break;
+        }
+    }
+    strOut += '\"';
+}
+
+void JsonBinding::EncodeBinaryValue(const std::string &strValue, std::string &strOut) {
+    EncodeBinaryString(strValue.c_str(), strValue.size(), strOut);
+}
+
+void JsonBinding::EncodeBinaryValue(int32 iValue, std::string &strOut) {
+    EncodeBinaryValue((int64) iValue, strOut);
+}
+
+void JsonBinding::EncodeBinaryValue(uint32 uiValue, std::string &strOut) {
+    EncodeBinaryValue((uint64) uiValue, strOut);
+}
+
+void JsonBinding::EncodeBinaryValue(int64 llValue, std::string &strOut) {
+    char szHead[JSON_BINARY_HEAD_MAX];
+    strOut.append(szHead, Json_BinaryInt(llValue < 0 ? 0 - (uint64) llValue : (uint64) llValue, llValue < 0, szHead));
+}
+
+void JsonBinding::EncodeBinaryValue(uint64 ullValue, std::string &strOut) {
+    char szHead[JSON_BINARY_HEAD_MAX];
+    strOut.append(szHead, Json_BinaryInt(ullValue, 0, szHead));
+}
+
+void JsonBinding::EncodeBinaryValue(bool bValue, std::string &strOut) {
+    strOut += (char) (bValue ? 0xf5 : 0xf4);
+}
+
+void JsonBinding::EncodeBinaryValue(float fValue, std::string &strOut) {
+    EncodeBinaryValue((double) fValue, strOut);
+}
+
+void JsonBinding::EncodeBinaryValue(double dValue, std::string &strOut) {
+    char szHead[JSON_BINARY_HEAD_MAX];
+    strOut.append(szHead, Json_BinaryDouble(dValue, szHead));
+}
+
+void JsonBinding::EncodeBinaryString(const char *szValue, size_t len, std::string &strOut) {
+    char szHead[JSON_BINARY_HEAD_MAX];
+    strOut.append(szHead, Json_BinaryHead(3, len, szHead));
+    strOut.append(szValue, len);
+}
+
+size_t JsonBinding::FindField(const char *szKey, const char *const *ppNames, size_t iStride, size_t count,
+                              size_t iHint) {
+    for (size_t n = 0; n < count; ++n) {
+        size_t i = (iHint + n) % count;
+        const char *szName = *(const char *const *) ((const char *) ppNames + i * iStride);
+        if (!strcasecmp(szName, szKey)) {
+            return (i);
+        }
+    }
+
+    return (count);
+}
+
+size_t JsonBinding::FindFold(const char *szFold, const char *const *ppFolds, size_t count, size_t iHint) {
+    for (size_t n = 0; n < count; ++n) {
+        size_t i = (iHint + n) % count;
+        if (ppFolds[i] == szFold) {
+            return (i);
+        }
+    }
+
+    return (count);
+}
+
+const char *const *JsonBinding::InternFields(const char *const *ppNames, size_t iStride, size_t count) {
+    const char **ppFolds = new(std::nothrow) const char *[count];
+    if (ppFolds == NULL) {
+        return (NULL);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const char *szAtom = Json_Intern(*(const char *const *) ((const char *) ppNames + i * iStride));
+        if (szAtom == NULL) {
+            delete[] ppFolds;
+            return (NULL);
+        }
+        ppFolds[i] = Json_AtomFold(szAtom);
+    }
+
+    return (ppFolds);
+}
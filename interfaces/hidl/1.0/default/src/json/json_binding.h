@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_BINDING_H_
+#define JSON_BINDING_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "json.h"
+#include "json_atom.h"
+#include "json_binary.h"
+#include "json_reader.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// Binds a plain struct to a json object, member by member:
+//
+//     JSON_SCHEMA(Battery,
+//         JSON_FIELD(Battery, level),
+//         JSON_FIELD(Battery, temperature))
+//
+// JsonBinding::Decode then reads the object straight off a Json_Reader into the
+// struct, no tree in between, and JsonBinding::Encode writes it back out.
+// Decode also takes a tree, for documents that are kept (and patched) anyway.
+// Keys match case-insensitively, like JsonObject and JsonView do by default.
+// Field names are interned (json_atom.h) on first use, or up front with
+// Intern: keys parsed as atoms are then matched to fields by pointer.
+// Decode reads Json_Binary documents as well as text (the reader tells them
+// apart), EncodeBinary writes one.
+// Members may be std::string, bool, the int types of json.h, float, double,
+// or another struct with a JSON_SCHEMA.
+
+template<class T>
+struct JsonField {
+    const char *name;
+
+    bool (*decode)(Json_Reader *pReader, T &oValue);
+
+    bool (*decodeItem)(const Json *pItem, T &oValue);
+
+    void (*encode)(const T &oValue, std::string &strOut);
+
+    void (*encodeBinary)(const T &oValue, std::string &strOut);
+};
+
+// specialized by JSON_SCHEMA, Fields() returns the field table and its size
+template<class T>
+struct JsonSchema;
+
+class JsonBinding {
+public:
+    // The next value of pReader into oValue. Keys without a field and values of
+    // another type are skipped, the members they would set keep their values.
+    // Returns false on a reader error, or when the value is not an object.
+    // Members decoded before a reader error keep their new values.
+    template<class T>
+    static bool Decode(Json_Reader *pReader, T &oValue);
+
+    // The next value of pReader is an object: decode its member szKey into oValue
+    // and skip the rest. Returns false when there is no such member.
+    template<class T>
+    static bool DecodeMember(Json_Reader *pReader, const char *szKey, T &oValue);
+
+    // The same from the object pItem. Returns false when pItem is NULL or not an object.
+    template<class T>
+    static bool Decode(const Json *pItem, T &oValue);
+
+    // Interns the field names of T now, so that the documents parsed from here on
+    // take their keys from the atom table. Returns false on memory fail.
+    template<class T>
+    static bool Intern() {
+        return (Folds<T>() != NULL);
+    }
+
+    template<class T>
+    static void Encode(const T &oValue, std::string &strOut);
+
+    template<class T>
+    static std::string Encode(const T &oValue) {
+        std::string strOut;
+        Encode(oValue, strOut);
+        return (strOut);
+    }
+
+    // oValue as a Json_Binary document, magic first
+    template<class T>
+    static void EncodeBinary(const T &oValue, std::string &strOut) {
+        strOut.append(JSON_BINARY_MAGIC, JSON_BINARY_MAGIC_LEN);
+        EncodeBinaryValue(oValue, strOut);
+    }
+
+    template<class T>
+    static std::string EncodeBinary(const T &oValue) {
+        std::string strOut;
+        EncodeBinary(oValue, strOut);
+        return (strOut);
+    }
+
+public:     // one member, picked by overload: scalars here, structs with a schema through Decode/Encode
+    static bool DecodeValue(Json_Reader *pReader, std::string &strValue);
+
+    static bool DecodeValue(Json_Reader *pReader, int32 &iValue);
+
+    static bool DecodeValue(Json_Reader *pReader, uint32 &uiValue);
+
+    static bool DecodeValue(Json_Reader *pReader, int64 &llValue);
+
+    static bool DecodeValue(Json_Reader *pReader, uint64 &ullValue);
+
+    static bool DecodeValue(Json_Reader *pReader, bool &bValue);
+
+    static bool DecodeValue(Json_Reader *pReader, float &fValue);
+
+    static bool DecodeValue(Json_Reader *pReader, double &dValue);
+
+    template<class T>
+    static bool DecodeValue(Json_Reader *pReader, T &oValue) {
+        return (Decode(pReader, oValue) || Json_ReaderGetError(pReader, NULL) == NULL);
+    }
+
+    // from a tree there is nothing to fail, a value of another type is left out
+    static bool DecodeValue(const Json *pItem, std::string &strValue);
+
+    static bool DecodeValue(const Json *pItem, int32 &iValue);
+
+    static bool DecodeValue(const Json *pItem, uint32 &uiValue);
+
+    static bool DecodeValue(const Json *pItem, int64 &llValue);
+
+    static bool DecodeValue(const Json *pItem, uint64 &ullValue);
+
+    static bool DecodeValue(const Json *pItem, bool &bValue);
+
+    static bool DecodeValue(const Json *pItem, float &fValue);
+
+    static bool DecodeValue(const Json *pItem, double &dValue);
+
+    template<class T>
+    static bool DecodeValue(const Json *pItem, T &oValue) {
+        Decode(pItem, oValue);
+        return (true);
+    }
+
+    static void EncodeValue(const std::string &strValue, std::string &strOut);
+
+    static void EncodeValue(int32 iValue, std::string &strOut);
+
+    static void EncodeValue(uint32 uiValue, std::string &strOut);
+
+    static void EncodeValue(int64 llValue, std::string &strOut);
+
+    static void EncodeValue(uint64 ullValue, std::string &strOut);
+
+    static void EncodeValue(bool bValue, std::string &strOut);
+
+    static void EncodeValue(float fValue, std::string &strOut);
+
+    static void EncodeValue(double dValue, std::string &strOut);
+
+    template<class T>
+    static void EncodeValue(const T &oValue, std::string &strOut) {
+        Encode(oValue, strOut);
+    }
+
+    // szValue quoted and escaped
+    static void EncodeString(const char *szValue, std::string &strOut);
+
+    static void EncodeBinaryValue(const std::string &strValue, std::string &strOut);
+
+    static void EncodeBinaryValue(int32 iValue, std::string &strOut);
+
+    static void EncodeBinaryValue(uint32 uiValue, std::string &strOut);
+
+    static void EncodeBinaryValue(int64 llValue, std::string &strOut);
+
+    static void EncodeBinaryValue(uint64 ullValue, std::string &strOut);
+
+    static void EncodeBinaryValue(bool bValue, std::string &strOut);
+
+    static void EncodeBinaryValue(float fValue, std::string &strOut);
+
+    static void EncodeBinaryValue(double dValue, std::string &strOut);
+
+    // a struct with a schema: a map of its fields, no magic
+    template<class T>
+    static void EncodeBinaryValue(const T &oValue, std::string &strOut);
+
+    // the head and bytes of a text string
+    static void EncodeBinaryString(const char *szValue, size_t len, std::string &strOut);
+
+private:
+    // index of the field named szKey, searched from iHint on (fields usually
+    // come in declaration order), count when there is none
+    static size_t FindField(const char *szKey, const char *const *ppNames, size_t iStride, size_t count, size_t iHint);
+
+    template<class T>
+    static size_t FindField(const char *szKey, const JsonField<T> *pFields, size_t count, size_t iHint) {
+        return (FindField(szKey, &pFields[0].name, sizeof(JsonField<T>), count, iHint));
+    }
+
+    // the same for a key that is an atom, by its fold (Json_AtomFold)
+    static size_t FindFold(const char *szFold, const char *const *ppFolds, size_t count, size_t iHint);
+
+    // the folds of the interned names, kept for good; NULL on memory fail
+    static const char *const *InternFields(const char *const *ppNames, size_t iStride, size_t count);
+
+    // those of the fields of T, interned by the first call
+    template<class T>
+    static const char *const *Folds() {
+        static const char *const *ppFolds = [] {
+            size_t count = 0;
+            const JsonField<T> *pFields = JsonSchema<T>::Fields(count);
+            return (InternFields(&pFields[0].name, sizeof(JsonField<T>), count));
+        }();
+        return (ppFolds);
+    }
+};
+
+template<class T, class M, M T::*Member>
+struct JsonMember {
+    static bool Decode(Json_Reader *pReader, T &oValue) {
+        return (JsonBinding::DecodeValue(pReader, oValue.*Member));
+    }
+
+    static bool DecodeItem(const Json *pItem, T &oValue) {
+        return (JsonBinding::DecodeValue(pItem, oValue.*Member));
+    }
+
+    static void Encode(const T &oValue, std::string &strOut) {
+        JsonBinding::EncodeValue(oValue.*Member, strOut);
+    }
+
+    static void EncodeBinary(const T &oValue, std::string &strOut) {
+        JsonBinding::EncodeBinaryValue(oValue.*Member, strOut);
+    }
+};
+
+#define JSON_FIELD(T, member) \
+    { #member, &JsonMember<T, decltype(T::member), &T::member>::Decode, \
+      &JsonMember<T, decltype(T::member), &T::member>::DecodeItem, \
+      &JsonMember<T, decltype(T::member), &T::member>::Encode, \
+      &JsonMember<T, decltype(T::member), &T::member>::EncodeBinary }
+
+#define JSON_SCHEMA(T, ...) \
+    template<> \
+    struct JsonSchema<T> { \
+        static const JsonField<T> *Fields(size_t &count) { \
+            static const JsonField<T> fields[] = {__VA_ARGS__}; \
+            count = sizeof(fields) / sizeof(fields[0]); \
+            return (fields); \
+        } \
+    };
+
+template<class T>
+bool JsonBinding::Decode(Json_Reader *pReader, T &oValue) {
+    int event = Json_ReaderNext(pReader);
+    if (event != Json_EventStartObject) {
+        if (event == Json_EventStartArray) {
+            Json_ReaderSkip(pReader);
+        }
+        return (false);
+    }
+
+    size_t count = 0, next = 0;
+    const JsonField<T> *pFields = JsonSchema<T>::Fields(count);
+    while ((event = Json_ReaderNext(pReader)) == Json_EventKey) {
+        size_t i = FindField(Json_ReaderItem(pReader)->valuestring, pFields, count, next);
+        if (i == count) {
+            if (Json_ReaderSkip(pReader) <= 0) {
+                return (false);
+            }
+            continue;
+        }
+
+        if (!pFields[i].decode(pReader, oValue)) {
+            return (false);
+        }
+        next = i + 1;
+    }
+
+    return (event == Json_EventEndObject);
+}
+
+template<class T>
+bool JsonBinding::DecodeMember(Json_Reader *pReader, const char *szKey, T &oValue) {
+    if (Json_ReaderNext(pReader) != Json_EventStartObject) {
+        return (false);
+    }
+
+    bool bFound = false;
+    int event;
+    while ((event = Json_ReaderNext(pReader)) == Json_EventKey) {
+        if (!bFound && FindField(Json_ReaderItem(pReader)->valuestring, &szKey, 0, 1, 0) == 0) {
+            bFound = true;
+            if (!Decode(pReader, oValue) && Json_ReaderGetError(pReader, NULL) != NULL) {
+                return (false);
+            }
+        } else if (Json_ReaderSkip(pReader) <= 0) {
+            return (false);
+        }
+    }
+
+    return (bFound && event == Json_EventEndObject);
+}
+
+template<class T>
+bool JsonBinding::Decode(const Json *pItem, T &oValue) {
+    if (pItem == NULL || (pItem->type & 255) != Json_Object) {
+        return (false);
+    }
+
+    size_t count = 0, next = 0;
+    const JsonField<T> *pFields = JsonSchema<T>::Fields(count);
+    const char *const *ppFolds = Folds<T>();
+    for (const Json *pChild = pItem->child; pChild != NULL; pChild = pChild->next) {
+        size_t i = ppFolds != NULL && (pChild->flags & Json_AtomString)
+                   ? FindFold(Json_AtomFold(pChild->string), ppFolds, count, next)
+                   : FindField(pChild->string, pFields, count, next);
+        if (i == count) {
+            continue;
+        }
+
+        pFields[i].decodeItem(pChild, oValue);
+        next = i + 1;
+    }
+
+    return (true);
+}
+
+template<class T>
+void JsonBinding::Encode(const T &oValue, std::string &strOut) {
+    size_t count = 0;
+    const JsonField<T> *pFields = JsonSchema<T>::Fields(count);
+
+    strOut += '{';
+    for (size_t i = 0; i < count; ++i) {
+        if (i) {
+            strOut += ',';
+        }
+        EncodeString(pFields[i].name, strOut);
+        strOut += ':';
+        pFields[i].encode(oValue, strOut);
+    }
+    strOut += '}';
+}
+
+template<class T>
+void JsonBinding::EncodeBinaryValue(const T &oValue, std::string &strOut) {
+    size_t count = 0;
+    const JsonField<T> *pFields = JsonSchema<T>::Fields(count);
+    char szHead[JSON_BINARY_HEAD_MAX];
+
+    strOut.append(szHead, Json_BinaryHead(5, count, szHead));
+    for (size_t i = 0; i < count; ++i) {
+        EncodeBinaryString(pFields[i].name, strlen(pFields[i].name), strOut);
+        pFields[i].encodeBinary(oValue, strOut);
+    }
+}
+
+#endif /* JSON_BINDING_H_ */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <new>
+
+#include "json_document.h"
+
+// A parsed tree takes about four times the bytes of its text: one arena block for most documents
+#define DOCUMENT_ARENA_RATIO 4
+
+struct JsonDocument::Shared {
+    std::atomic<int> iRefs;
+    Json *pJsonData;
+    Json_Arena *pArena;
+};
+
+JsonDocument::JsonDocument() : m_pShared(NULL), m_bCaseSensitive(false) {
+}
+
+JsonDocument::JsonDocument(const std::string &strJson) : m_pShared(NULL), m_bCaseSensitive(false) {
+    Parse(strJson);
+}
+
+JsonDocument::JsonDocument(const JsonObject &oJsonObject) : m_pShared(NULL), m_bCaseSensitive(false) {
+    // a copy on the heap: the data of oJsonObject may live in an arena or an in situ buffer of its own
+    Json *pJsonData = Json_Duplicate(oJsonObject.View().GetJson(), 1);
+    if (pJsonData != NULL) {
+        Adopt(pJsonData, NULL);
+    }
+}
+
+JsonDocument::JsonDocument(const JsonDocument &oDocument)
+        : m_pShared(oDocument.m_pShared), m_bCaseSensitive(oDocument.m_bCaseSensitive) {
+    if (m_pShared != NULL) {
+        m_pShared->iRefs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+JsonDocument::JsonDocument(JsonDocument &&oDocument)
+        : m_pShared(oDocument.m_pShared), m_strErrMsg(std::move(oDocument.m_strErrMsg)),
+          m_bCaseSensitive(oDocument.m_bCaseSensitive) {
+    oDocument.m_pShared = NULL;
+}
+
+JsonDocument::~JsonDocument() {
+    Release();
+}
+
+JsonDocument &JsonDocument::operator=(const JsonDocument &oDocument) {
+    if (m_pShared != oDocument.m_pShared) {
+        if (oDocument.m_pShared != NULL) {
+            oDocument.m_pShared->iRefs.fetch_add(1, std::memory_order_relaxed);
+        }
+        Release();
+        m_pShared = oDocument.m_pShared;
+    }
+    m_bCaseSensitive = oDocument.m_bCaseSensitive;
+
+    return (*this);
+}
+
+JsonDocument &JsonDocument::operator=(JsonDocument &&oDocument) {
+    if (this != &oDocument) {
+        Release();
+        m_pShared = oDocument.m_pShared;
+        m_strErrMsg = std::move(oDocument.m_strErrMsg);
+        m_bCaseSensitive = oDocument.m_bCaseSensitive;
+        oDocument.m_pShared = NULL;
+    }
+
+    return (*this);
+}
+
+bool JsonDocument::Parse(const std::string &strJson) {
+    Release();
+
+    Json_Arena *pArena = Json_ArenaCreate(strJson.size() * DOCUMENT_ARENA_RATIO);
+    if (pArena == NULL) {
+        m_strErrMsg = "out of memory!";
+        return (false);
+    }
+
+    Json *pJsonData = Json_ParseInArena(strJson.c_str(), pArena);
+    if (pJsonData == NULL) {
+        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        Json_ArenaDestroy(pArena);
+        return (false);
+    }
+
+    return (Adopt(pJsonData, pArena));
+}
+
+void JsonDocument::Clear() {
+    Release();
+}
+
+JsonView JsonDocument::View() const {
+    return (JsonView(m_pShared != NULL ? m_pShared->pJsonData : NULL, m_bCaseSensitive));
+}
+
+std::string JsonDocument::ToString() const {
+    return (View().ToString());
+}
+
+int JsonDocument::GetRefCount() const {
+    return (m_pShared != NULL ? m_pShared->iRefs.load(std::memory_order_relaxed) : 0);
+}
+
+bool JsonDocument::Adopt(Json *pJsonData, Json_Arena *pArena) {
+    // every table a lookup could build is built now, before anyone else can see the tree
+    Shared *pShared = Json_Freeze(pJsonData) ? new(std::nothrow) Shared : NULL;
+    if (pShared == NULL) {
+        m_strErrMsg = "out of memory!";
+        Json_Delete(pJsonData);
+        Json_ArenaDestroy(pArena);
+        return (false);
+    }
+
+    pShared->iRefs.store(1, std::memory_order_relaxed);
+    pShared->pJsonData = pJsonData;
+    pShared->pArena = pArena;
+    m_pShared = pShared;
+
+    return (true);
+}
+
+void JsonDocument::Release() {
+    if (m_pShared == NULL) {
+        return;
+    }
+
+    // the last owner sees every read of the others done before it frees
+    if (m_pShared->iRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Json_Delete(m_pShared->pJsonData);
+        Json_ArenaDestroy(m_pShared->pArena);
+        delete m_pShared;
+    }
+    m_pShared = NULL;
+}
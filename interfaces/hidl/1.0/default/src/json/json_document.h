@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_DOCUMENT_H_
+#define JSON_DOCUMENT_H_
+
+#include <string>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "json.h"
+#include "json_arena.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "json_object.h"
+#include "json_view.h"
+
+// A parsed document frozen for sharing: read-only and reference counted.
+// Copying a JsonDocument copies a pointer and counts one more owner, the tree
+// goes away with the last one. The tree is frozen (Json_Freeze) once it is
+// built, so any number of threads may read it through View() at the same
+// time, with no lock and no copy; each thread holds its own JsonDocument.
+// A JsonDocument itself is not for sharing between threads, like a std::string.
+//
+//     JsonDocument oConfig(strJson);          // parse once
+//     JsonDocument oMine = oConfig;           // another owner, same tree
+//     oMine.View()["cpuset"][0]("name");
+class JsonDocument {
+public:
+    JsonDocument();
+
+    explicit JsonDocument(const std::string &strJson);
+
+    // a frozen copy of the data of oJsonObject, which stays as it is
+    explicit JsonDocument(const JsonObject &oJsonObject);
+
+    JsonDocument(const JsonDocument &oDocument);
+
+    JsonDocument(JsonDocument &&oDocument);
+
+    ~JsonDocument();
+
+    JsonDocument &operator=(const JsonDocument &oDocument);
+
+    JsonDocument &operator=(JsonDocument &&oDocument);
+
+    // parses into a new document: other owners of the old one keep it
+    bool Parse(const std::string &strJson);
+
+    void Clear();
+
+    bool IsEmpty() const {
+        return (m_pShared == NULL);
+    }
+
+    const std::string &GetErrMsg() const {
+        return (m_strErrMsg);
+    }
+
+    // keys match case-insensitively by default, for the views of this owner
+    void SetCaseSensitive(bool bCaseSensitive) {
+        m_bCaseSensitive = bCaseSensitive;
+    }
+
+    // valid while any owner of the document is; the tree must not be changed through it
+    JsonView View() const;
+
+    std::string ToString() const;
+
+    // owners of the document, 0 when empty
+    int GetRefCount() const;
+
+private:
+    struct Shared;
+
+    // freezes pJsonData and takes it over, with the arena it lives in (may be NULL)
+    bool Adopt(Json *pJsonData, Json_Arena *pArena);
+
+    void Release();
+
+private:
+    Shared *m_pShared;
+    std::string m_strErrMsg;
+    bool m_bCaseSensitive;
+};
+
+#endif /* JSON_DOCUMENT_H_ */
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_NUMBER_H_
+#define _JSON_NUMBER_H_
+
+#include "json.h"
+
+/*
+ * Longest text Json_FormatDouble and Json_FormatUint64 write, with the 0.
+ */
+#define JSON_NUMBER_BUFFER 32
+
+/*
+ * w * 10^q rounded to the nearest double (ties to even), for w of at most 19
+ * significant digits: exact powers of ten when both fit a double, else
+ * Eisel-Lemire over a table of 128 bit powers of five.
+ * Returns 1 with value set, 0 when the result would be subnormal, which the
+ * caller settles with strtod.
+ */
+extern int Json_DecimalToDouble(uint64 w, int q, double *value);
+
+/*
+ * The shortest digits that read back as value (Grisu2, which is the shortest
+ * for all but a handful of doubles and always reads back exactly), in the
+ * form 1.5, 0.001, 1e21 or 2.5e-7. Integral values keep a ".0" so they
+ * parse back as Json_Double. NaN and infinities have no JSON form and are
+ * written as null.
+ * buffer must hold JSON_NUMBER_BUFFER bytes. Returns the length.
+ */
+extern int Json_FormatDouble(double value, char *buffer);
+
+/*
+ * value in decimal, after a '-' when negative is set.
+ * buffer must hold JSON_NUMBER_BUFFER bytes. Returns the length.
+ */
+extern int Json_FormatUint64(uint64 value, int negative, char *buffer);
+
+#endif
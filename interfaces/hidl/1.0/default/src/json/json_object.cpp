@@ -16,22 +16,47 @@
 
 #include "json_object.h"
 
-JsonObject::JsonObject() : m_pJsonData(NULL), m_pExternJsonDataRef(NULL) {
+JsonObject::JsonObject() : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_bCaseSensitive(false) {
     // m_pJsonData = Json_CreateObject();
 }
 
-JsonObject::JsonObject(const std::string &strJson) : m_pJsonData(NULL), m_pExternJsonDataRef(NULL) {
+JsonObject::JsonObject(const std::string &strJson)
+        : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_bCaseSensitive(false) {
     Parse(strJson);
 }
 
-JsonObject::JsonObject(const JsonObject *pJsonObject) : m_pJsonData(NULL), m_pExternJsonDataRef(NULL) {
+JsonObject::JsonObject(const JsonObject *pJsonObject)
+        : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_bCaseSensitive(false) {
     if (pJsonObject) {
-        Parse(pJsonObject->ToString());
+        m_pJsonData = Json_Duplicate(pJsonObject->View().GetJson(), 1);
+        m_bCaseSensitive = pJsonObject->m_bCaseSensitive;
     }
 }
 
-JsonObject::JsonObject(const JsonObject &oJsonObject) : m_pJsonData(NULL), m_pExternJsonDataRef(NULL) {
-    Parse(oJsonObject.ToString());
+JsonObject::JsonObject(const JsonObject &oJsonObject)
+        : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_bCaseSensitive(oJsonObject.m_bCaseSensitive) {
+    m_pJsonData = Json_Duplicate(oJsonObject.View().GetJson(), 1);
+}
+
+JsonObject::JsonObject(JsonObject &&oJsonObject)
+        : m_pJsonData(NULL), m_pExternJsonDataRef(NULL), m_bCaseSensitive(oJsonObject.m_bCaseSensitive) {
+    if (oJsonObject.m_pJsonData == NULL) {
+        // a sub object owns nothing, its data belongs to its parent and may go with it: copy it
+        m_pJsonData = Json_Duplicate(oJsonObject.View().GetJson(), 1);
+        m_itKey = m_listKeys.begin();
+        return;
+    }
+
+    m_pJsonData = oJsonObject.m_pJsonData;
+    m_strErrMsg = std::move(oJsonObject.m_strErrMsg);
+    m_mapJsonArrayRef = std::move(oJsonObject.m_mapJsonArrayRef);
+    m_mapJsonObjectRef = std::move(oJsonObject.m_mapJsonObjectRef);
+    m_listKeys = std::move(oJsonObject.m_listKeys);
+    m_itKey = m_listKeys.begin();
+    oJsonObject.m_pJsonData = NULL;
+    oJsonObject.m_mapJsonArrayRef.clear();
+    oJsonObject.m_mapJsonObjectRef.clear();
+    oJsonObject.m_listKeys.clear();
 }
 
 JsonObject::~JsonObject() {
@@ -39,12 +64,49 @@ JsonObject::~JsonObject() {
 }
 
 JsonObject &JsonObject::operator=(const JsonObject &oJsonObject) {
-    Parse(oJsonObject.ToString().c_str());
+    if (this != &oJsonObject) {
+        // copy first, oJsonObject may be one of the sub objects Clear() deletes
+        Json *pJsonData = Json_Duplicate(oJsonObject.View().GetJson(), 1);
+        bool bCaseSensitive = oJsonObject.m_bCaseSensitive;
+        Clear();
+        m_pJsonData = pJsonData;
+        m_bCaseSensitive = bCaseSensitive;
+    }
+
+    return (*this);
+}
+
+JsonObject &JsonObject::operator=(JsonObject &&oJsonObject) {
+    if (this == &oJsonObject) {
+        return (*this);
+    }
+
+    if (oJsonObject.m_pJsonData == NULL) {
+        // a sub object owns nothing, its data may even belong to this object: copy it
+        return (operator=(static_cast<const JsonObject &>(oJsonObject)));
+    }
+
+    // take the data before Clear(), which may delete oJsonObject (a sub object that was added to)
+    Json *pJsonData = oJsonObject.m_pJsonData;
+    bool bCaseSensitive = oJsonObject.m_bCaseSensitive;
+    oJsonObject.m_pJsonData = NULL;
+    std::map<unsigned int, JsonObject *> mapJsonArrayRef(std::move(oJsonObject.m_mapJsonArrayRef));
+    std::map<std::string, JsonObject *> mapJsonObjectRef(std::move(oJsonObject.m_mapJsonObjectRef));
+    oJsonObject.m_mapJsonArrayRef.clear();
+    oJsonObject.m_mapJsonObjectRef.clear();
+    oJsonObject.Clear();
+
+    Clear();
+    m_pJsonData = pJsonData;
+    m_bCaseSensitive = bCaseSensitive;
+    m_mapJsonArrayRef.swap(mapJsonArrayRef);
+    m_mapJsonObjectRef.swap(mapJsonObjectRef);
+
     return (*this);
 }
 
 bool JsonObject::operator==(const JsonObject &oJsonObject) const {
-    return (this->ToString() == oJsonObject.ToString());
+    return (Json_Compare(View().GetJson(), oJsonObject.View().GetJson()) != 0);
 }
 
 bool JsonObject::AddEmptySubObject(const std::string &strKey) {
@@ -157,20 +219,22 @@ JsonObject &JsonObject::operator[](const std::string &strKey) {
         Json *pJsonStruct = NULL;
         if (m_pJsonData != NULL) {
             if (m_pJsonData->type == Json_Object) {
-                pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+                pJsonStruct = GetObjectItem(m_pJsonData, strKey);
             }
         } else if (m_pExternJsonDataRef != NULL) {
             if (m_pExternJsonDataRef->type == Json_Object) {
-                pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+                pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
             }
         }
 
         if (pJsonStruct == NULL) {
             JsonObject *pJsonObject = new JsonObject();
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
             m_mapJsonObjectRef.insert(std::pair<std::string, JsonObject *>(strKey, pJsonObject));
             return (*pJsonObject);
         } else {
             JsonObject *pJsonObject = new JsonObject(pJsonStruct);
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
             m_mapJsonObjectRef.insert(std::pair<std::string, JsonObject *>(strKey, pJsonObject));
             return (*pJsonObject);
         }
@@ -195,10 +259,12 @@ JsonObject &JsonObject::operator[](unsigned int uiWhich) {
         }
         if (pJsonStruct == NULL) {
             JsonObject *pJsonObject = new JsonObject();
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
             m_mapJsonArrayRef.insert(std::pair<unsigned int, JsonObject *>(uiWhich, pJsonObject));
             return (*pJsonObject);
         } else {
             JsonObject *pJsonObject = new JsonObject(pJsonStruct);
+            pJsonObject->m_bCaseSensitive = m_bCaseSensitive;
             m_mapJsonArrayRef.insert(std::pair<unsigned int, JsonObject *>(uiWhich, pJsonObject));
             return (*pJsonObject);
         }
@@ -211,11 +277,11 @@ std::string JsonObject::operator()(const std::string &strKey) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -318,6 +384,50 @@ bool JsonObject::Parse(const std::string &strJson) {
     return (true);
 }
 
+bool JsonObject::Parse(const std::string &strJson, Json_Arena *pArena) {
+    Clear();
+    m_pJsonData = Json_ParseInArena(strJson.c_str(), pArena);
+    if (m_pJsonData == NULL) {
+        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        return (false);
+    }
+
+    return (true);
+}
+
+bool JsonObject::ParseInSitu(std::string &strJson) {
+    Clear();
+    m_pJsonData = Json_ParseInSitu(&strJson[0]);
+    if (m_pJsonData == NULL) {
+        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        return (false);
+    }
+
+    return (true);
+}
+
+bool JsonObject::ParseInSitu(std::string &strJson, Json_Arena *pArena) {
+    Clear();
+    m_pJsonData = Json_ParseInSituInArena(&strJson[0], pArena);
+    if (m_pJsonData == NULL) {
+        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        return (false);
+    }
+
+    return (true);
+}
+
+bool JsonObject::ParseMembers(const std::string &strJson, const char *const *ppKeys, int iCount) {
+    Clear();
+    m_pJsonData = Json_ParseMembers(strJson.c_str(), ppKeys, iCount);
+    if (m_pJsonData == NULL) {
+        m_strErrMsg = std::string("prase json string error at ") + (Json_GetErrorPtr() != NULL ? Json_GetErrorPtr() : "");
+        return (false);
+    }
+
+    return (true);
+}
+
 void JsonObject::Clear() {
     m_pExternJsonDataRef = NULL;
     if (m_pJsonData != NULL) {
@@ -325,6 +435,10 @@ void JsonObject::Clear() {
         m_pJsonData = NULL;
     }
 
+    ClearSubObjects();
+}
+
+void JsonObject::ClearSubObjects() {
     for (std::map<unsigned int, JsonObject *>::iterator iter = m_mapJsonArrayRef.begin();
          iter != m_mapJsonArrayRef.end(); ++iter) {
         if (iter->second != NULL) {
@@ -414,11 +528,11 @@ bool JsonObject::Get(const std::string &strKey, JsonObject &oJsonObject) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -426,25 +540,25 @@ bool JsonObject::Get(const std::string &strKey, JsonObject &oJsonObject) const {
         return (false);
     }
 
-    char *pJsonString = Json_Print(pJsonStruct);
-    std::string strJsonData = pJsonString;
-    free(pJsonString);
-    if (oJsonObject.Parse(strJsonData)) {
-        return (true);
-    } else {
+    Json *pJsonCopy = Json_Duplicate(pJsonStruct, 1);
+    if (pJsonCopy == NULL) {
         return (false);
     }
+
+    oJsonObject.Clear();
+    oJsonObject.m_pJsonData = pJsonCopy;
+    return (true);
 }
 
 bool JsonObject::Get(const std::string &strKey, std::string &strValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -464,11 +578,11 @@ bool JsonObject::Get(const std::string &strKey, int32 &iValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -491,11 +605,11 @@ bool JsonObject::Get(const std::string &strKey, uint32 &uiValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -518,11 +632,11 @@ bool JsonObject::Get(const std::string &strKey, int64 &llValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
     if (pJsonStruct == NULL) {
@@ -544,11 +658,11 @@ bool JsonObject::Get(const std::string &strKey, uint64 &ullValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -571,11 +685,11 @@ bool JsonObject::Get(const std::string &strKey, bool &bValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -595,11 +709,11 @@ bool JsonObject::Get(const std::string &strKey, float &fValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -622,11 +736,11 @@ bool JsonObject::Get(const std::string &strKey, double &dValue) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -649,11 +763,11 @@ bool JsonObject::IsNull(const std::string &strKey) const {
     Json *pJsonStruct = NULL;
     if (m_pJsonData != NULL) {
         if (m_pJsonData->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pJsonData, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pJsonData, strKey);
         }
     } else if (m_pExternJsonDataRef != NULL) {
         if (m_pExternJsonDataRef->type == Json_Object) {
-            pJsonStruct = Json_GetObjectItem(m_pExternJsonDataRef, strKey.c_str());
+            pJsonStruct = GetObjectItem(m_pExternJsonDataRef, strKey);
         }
     }
 
@@ -689,9 +803,9 @@ bool JsonObject::Add(const std::string &strKey, const JsonObject &oJsonObject) {
         return (false);
     }
 
-    Json *pJsonStruct = Json_Parse(oJsonObject.ToString().c_str());
+    Json *pJsonStruct = Json_Duplicate(oJsonObject.View().GetJson(), 1);
     if (pJsonStruct == NULL) {
-        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        m_strErrMsg = std::string("json object is empty or copy failed!");
         return (false);
     }
 
@@ -1078,9 +1192,9 @@ bool JsonObject::Replace(const std::string &strKey, const JsonObject &oJsonObjec
         return (false);
     }
 
-    Json *pJsonStruct = Json_Parse(oJsonObject.ToString().c_str());
+    Json *pJsonStruct = Json_Duplicate(oJsonObject.View().GetJson(), 1);
     if (pJsonStruct == NULL) {
-        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        m_strErrMsg = std::string("json object is empty or copy failed!");
         return (false);
     }
 
@@ -1489,14 +1603,14 @@ bool JsonObject::Get(int iWhich, JsonObject &oJsonObject) const {
         return (false);
     }
 
-    char *pJsonString = Json_Print(pJsonStruct);
-    std::string strJsonData = pJsonString;
-    free(pJsonString);
-    if (oJsonObject.Parse(strJsonData)) {
-        return (true);
-    } else {
+    Json *pJsonCopy = Json_Duplicate(pJsonStruct, 1);
+    if (pJsonCopy == NULL) {
         return (false);
     }
+
+    oJsonObject.Clear();
+    oJsonObject.m_pJsonData = pJsonCopy;
+    return (true);
 }
 
 bool JsonObject::Get(int iWhich, std::string &strValue) const {
@@ -1752,9 +1866,9 @@ bool JsonObject::Add(const JsonObject &oJsonObject) {
         return (false);
     }
 
-    Json *pJsonStruct = Json_Parse(oJsonObject.ToString().c_str());
+    Json *pJsonStruct = Json_Duplicate(oJsonObject.View().GetJson(), 1);
     if (pJsonStruct == NULL) {
-        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        m_strErrMsg = std::string("json object is empty or copy failed!");
         return (false);
     }
 
@@ -2125,9 +2239,9 @@ bool JsonObject::AddAsFirst(const JsonObject &oJsonObject) {
         return (false);
     }
 
-    Json *pJsonStruct = Json_Parse(oJsonObject.ToString().c_str());
+    Json *pJsonStruct = Json_Duplicate(oJsonObject.View().GetJson(), 1);
     if (pJsonStruct == NULL) {
-        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        m_strErrMsg = std::string("json object is empty or copy failed!");
         return (false);
     }
 
@@ -2526,9 +2640,9 @@ bool JsonObject::Replace(int iWhich, const JsonObject &oJsonObject) {
         return (false);
     }
 
-    Json *pJsonStruct = Json_Parse(oJsonObject.ToString().c_str());
+    Json *pJsonStruct = Json_Duplicate(oJsonObject.View().GetJson(), 1);
     if (pJsonStruct == NULL) {
-        m_strErrMsg = std::string("prase json string error at ") + Json_GetErrorPtr();
+        m_strErrMsg = std::string("json object is empty or copy failed!");
         return (false);
     }
 
@@ -2919,5 +3033,126 @@ bool JsonObject::ReplaceWithNull(int iWhich) {
 }
 
 JsonObject::JsonObject(Json *pJsonData)
-        : m_pJsonData(NULL), m_pExternJsonDataRef(pJsonData) {
+        : m_pJsonData(NULL), m_pExternJsonDataRef(pJsonData), m_bCaseSensitive(false) {
+}
+
+void JsonObject::SetCaseSensitive(bool bCaseSensitive) {
+    m_bCaseSensitive = bCaseSensitive;
+    for (std::map<unsigned int, JsonObject *>::iterator iter = m_mapJsonArrayRef.begin();
+         iter != m_mapJsonArrayRef.end(); ++iter) {
+        iter->second->SetCaseSensitive(bCaseSensitive);
+    }
+
+    for (std::map<std::string, JsonObject *>::iterator iter = m_mapJsonObjectRef.begin();
+         iter != m_mapJsonObjectRef.end(); ++iter) {
+        iter->second->SetCaseSensitive(bCaseSensitive);
+    }
+}
+
+Json *JsonObject::GetObjectItem(Json *pJsonData, const std::string &strKey) const {
+    if (m_bCaseSensitive) {
+        return (Json_GetObjectItemCaseSensitive(pJsonData, strKey.c_str()));
+    }
+
+    return (Json_GetObjectItem(pJsonData, strKey.c_str()));
+}
+
+JsonView JsonObject::View() const {
+    return (JsonView((m_pJsonData != NULL) ? m_pJsonData : m_pExternJsonDataRef, m_bCaseSensitive));
+}
+
+bool JsonObject::MergePatch(const JsonObject &oPatch) {
+    // a sub object (or this object itself) may be part of the data being patched: patch with a copy
+    Json *pPatchCopy = NULL;
+    Json *pPatchData = oPatch.View().GetJson();
+    if (pPatchData != NULL && (oPatch.m_pJsonData == NULL || &oPatch == this)) {
+        pPatchCopy = Json_Duplicate(pPatchData, 1);
+        pPatchData = pPatchCopy;
+    }
+
+    if (pPatchData == NULL) {
+        m_strErrMsg = "patch is null!";
+        return (false);
+    }
+
+    if (m_pJsonData == NULL && m_pExternJsonDataRef == NULL) {
+        m_pJsonData = Json_CreateObject();
+    }
+
+    Json *pFocusData = (m_pJsonData != NULL) ? m_pJsonData : m_pExternJsonDataRef;
+    if (pFocusData == NULL) {
+        Json_Delete(pPatchCopy);
+        m_strErrMsg = "json data is null!";
+        return (false);
+    }
+
+    // the patch may delete what they point to
+    ClearSubObjects();
+    bool bPatched = (Json_MergePatch(pFocusData, pPatchData, m_bCaseSensitive) != 0);
+    Json_Delete(pPatchCopy);
+    if (!bPatched) {
+        m_strErrMsg = "patch failed, out of memory!";
+    }
+
+    return (bPatched);
+}
+
+JsonObject JsonObject::MergeDiff(const JsonObject &oTarget) const {
+    JsonObject oPatch;
+    Json *pFromData = View().GetJson();
+    Json *pToData = oTarget.View().GetJson();
+    if (pToData != NULL) {
+        // an empty object is patched as {}, and takes all of oTarget
+        oPatch.m_pJsonData = (pFromData != NULL) ? Json_MergeDiff(pFromData, pToData) : Json_Duplicate(pToData, 1);
+    }
+    oPatch.m_bCaseSensitive = m_bCaseSensitive;
+
+    return (oPatch);
+}
+
+JsonObjectIterator JsonObject::begin() const {
+    Json *pFocusData = (m_pJsonData != NULL) ? m_pJsonData : m_pExternJsonDataRef;
+    if (pFocusData == NULL || (pFocusData->type != Json_Array && pFocusData->type != Json_Object)) {
+        return (JsonObjectIterator(NULL, m_bCaseSensitive));
+    }
+
+    return (JsonObjectIterator(pFocusData->child, m_bCaseSensitive));
+}
+
+JsonObjectIterator JsonObject::end() const {
+    return (JsonObjectIterator(NULL, m_bCaseSensitive));
+}
+
+JsonObjectIterator::JsonObjectIterator(Json *pNode, bool bCaseSensitive)
+        : m_pNode(pNode), m_oCurrent(pNode) {
+    m_oCurrent.m_bCaseSensitive = bCaseSensitive;
+}
+
+JsonObjectIterator::JsonObjectIterator(const JsonObjectIterator &oIter)
+        : m_pNode(oIter.m_pNode), m_oCurrent(oIter.m_pNode) {
+    m_oCurrent.m_bCaseSensitive = oIter.m_oCurrent.m_bCaseSensitive;
+}
+
+JsonObjectIterator &JsonObjectIterator::operator=(const JsonObjectIterator &oIter) {
+    if (this != &oIter) {
+        m_oCurrent.m_bCaseSensitive = oIter.m_oCurrent.m_bCaseSensitive;
+        Seek(oIter.m_pNode);
+    }
+
+    return (*this);
+}
+
+JsonObjectIterator &JsonObjectIterator::operator++() {
+    if (m_pNode != NULL) {
+        Seek(m_pNode->next);
+    }
+
+    return (*this);
+}
+
+void JsonObjectIterator::Seek(Json *pNode) {
+    // drops the sub objects cached for the previous item
+    m_oCurrent.Clear();
+    m_oCurrent.m_pExternJsonDataRef = pNode;
+    m_pNode = pNode;
 }
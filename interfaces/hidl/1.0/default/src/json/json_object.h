@@ -39,11 +39,16 @@ extern "C" {
 #endif
 
 #include "json.h"
+#include "json_arena.h"
 
 #ifdef __cplusplus
 }
 #endif
 
+#include "json_view.h"
+
+class JsonObjectIterator;
+
 class JsonObject {
 public:     // method of ordinary json object or json array
     JsonObject();
@@ -52,16 +57,34 @@ public:     // method of ordinary json object or json array
 
     JsonObject(const JsonObject *pJsonObject);
 
+    // copies are deep and independent of any arena or in situ buffer of the source
     JsonObject(const JsonObject &oJsonObject);
 
+    // takes the data over, oJsonObject is left empty
+    JsonObject(JsonObject &&oJsonObject);
+
     virtual ~JsonObject();
 
     JsonObject &operator=(const JsonObject &oJsonObject);
 
+    JsonObject &operator=(JsonObject &&oJsonObject);
+
     bool operator==(const JsonObject &oJsonObject) const;
 
     bool Parse(const std::string &strJson);
 
+    // nodes and strings come from pArena, which must outlive this object (or its next Parse/Clear)
+    bool Parse(const std::string &strJson, Json_Arena *pArena);
+
+    // strJson is unescaped in place and its strings are used as they are: it is
+    // garbage afterwards, and must outlive this object (or its next Parse/Clear)
+    bool ParseInSitu(std::string &strJson);
+
+    bool ParseInSitu(std::string &strJson, Json_Arena *pArena);
+
+    // only the members of the object strJson named in ppKeys are built, the others are checked and skipped
+    bool ParseMembers(const std::string &strJson, const char *const *ppKeys, int iCount);
+
     void Clear();
 
     bool IsEmpty() const;
@@ -76,15 +99,38 @@ public:     // method of ordinary json object or json array
         return (m_strErrMsg);
     }
 
+    // keys match case-insensitively by default, true switches this object
+    // and the sub objects reached through it to exact matching
+    void SetCaseSensitive(bool bCaseSensitive);
+
+    // allocation free read access to the data, valid until the next Parse/Clear
+    // or change to this object
+    JsonView View() const;
+
+    // applies oPatch as a JSON Merge Patch (RFC 7386) in place: members set to null
+    // are deleted, objects are merged member by member, anything else replaces the
+    // value. Sub objects taken from this object before are invalid afterwards.
+    bool MergePatch(const JsonObject &oPatch);
+
+    // the merge patch that turns this object into oTarget, an empty json object when
+    // both hold the same members (nulls in oTarget can't be expressed, see Json_MergeDiff)
+    JsonObject MergeDiff(const JsonObject &oTarget) const;
+
 public:     // method of ordinary json object
     bool AddEmptySubObject(const std::string &strKey);
 
     bool AddEmptySubArray(const std::string &strKey);
 
+    // copies every key before the first one is returned: Members() walks them without a copy
     bool GetKey(std::string &strKey);
 
     void ResetTraversing();
 
+    // for (const JsonView::Member &oMember : oJson.Members()) { ... }, see JsonView::Members
+    JsonView::MemberRange Members() const {
+        return (View().Members());
+    }
+
     JsonObject &operator[](const std::string &strKey);
 
     std::string operator()(const std::string &strKey) const;
@@ -237,9 +283,29 @@ public:     // method of json array
 
     bool ReplaceWithNull(int iWhich);      // replace with a null value
 
+public:     // forward iteration over the items of a json array (the values of a json object)
+    // for (JsonObject &oItem : oJson["cpuset"]) { ... }, one step per item, no lookup by position
+    JsonObjectIterator begin() const;
+
+    JsonObjectIterator end() const;
+
+    // fn(JsonView oItem) for each item of a json array, no wrapper per item: see JsonView::ForEach
+    template<typename Fn>
+    int ForEach(Fn fn) const {
+        return (View().ForEach(fn));
+    }
+
 private:
+    friend class JsonObjectIterator;
+
     JsonObject(Json *pJsonData);
 
+    Json *GetObjectItem(Json *pJsonData, const std::string &strKey) const;
+
+    // deletes the wrappers handed out by operator[] (not the data they point to)
+    // and forgets the keys GetKey was going through
+    void ClearSubObjects();
+
 private:
     Json *m_pJsonData;
     Json *m_pExternJsonDataRef;
@@ -248,6 +314,49 @@ private:
     std::map<std::string, JsonObject *> m_mapJsonObjectRef;
     std::list <std::string> m_listKeys;
     std::list<std::string>::const_iterator m_itKey;
+    bool m_bCaseSensitive;
+};
+
+class JsonObjectIterator {
+public:
+    JsonObjectIterator(const JsonObjectIterator &oIter);
+
+    JsonObjectIterator &operator=(const JsonObjectIterator &oIter);
+
+    // the wrapper is reused, sub objects taken from it are only valid until the next step
+    JsonObject &operator*() {
+        return (m_oCurrent);
+    }
+
+    JsonObject *operator->() {
+        return (&m_oCurrent);
+    }
+
+    JsonObjectIterator &operator++();
+
+    bool operator==(const JsonObjectIterator &oIter) const {
+        return (m_pNode == oIter.m_pNode);
+    }
+
+    bool operator!=(const JsonObjectIterator &oIter) const {
+        return (m_pNode != oIter.m_pNode);
+    }
+
+    // key of the current value when iterating a json object, NULL for array items
+    const char *GetKey() const {
+        return (m_pNode != NULL ? m_pNode->string : NULL);
+    }
+
+private:
+    friend class JsonObject;
+
+    JsonObjectIterator(Json *pNode, bool bCaseSensitive);
+
+    void Seek(Json *pNode);
+
+private:
+    Json *m_pNode;
+    JsonObject m_oCurrent;
 };
 
 #endif /* JsonHELPER_H_ */
\ No newline at end of file
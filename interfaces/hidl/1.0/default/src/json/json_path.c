@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "json_path.h"
+
+/*
+ * The pointers form a trie: node 0 is the root, every other node one
+ * segment under its parent.
+ */
+typedef struct Json_PathNode {
+    /* the unescaped segment, 0 for the root and for "*" */
+    char *key;
+
+    /* the segment as an array index, -1 when it is not one */
+    int index;
+
+    int wildcard;
+
+    /* first child and next sibling, -1 for none */
+    int child;
+    int sibling;
+
+    /* the first pointer that ends here, -1 for none */
+    int end;
+} Json_PathNode;
+
+struct Json_Path {
+    int count;
+    int case_sensitive;
+
+    Json_PathNode *nodes;
+    int size;
+    int capacity;
+
+    /* next_end[pointer]: the next pointer that ends on the same node */
+    int *next_end;
+};
+
+typedef struct {
+    const Json_Path *path;
+    Json_PathCallback callback;
+    void *context;
+    int matches;
+} Json_PathWalk;
+
+/*
+ * The array index a segment stands for: digits without a leading zero.
+ */
+static int segment_index(const char *key) {
+    int index = 0, digits = 0;
+
+    if (key[0] == '0') {
+        return key[1] ? -1 : 0;
+    }
+
+    for (; *key; key++, digits++) {
+        if (*key < '0' || *key > '9' || digits == 9) {
+            return -1;
+        }
+        index = index * 10 + (*key - '0');
+    }
+
+    return digits ? index : -1;
+}
+
+/*
+ * The child of parent for the segment [start, end), added when missing.
+ * Returns -1 on a bad escape or memory fail.
+ */
+static int add_segment(Json_Path *path, int parent, const char *start, const char *end) {
+    Json_PathNode *node, *grown;
+    char *key, *out;
+    int wildcard = end - start == 1 && *start == '*';
+    int i;
+
+    if (!(key = (char *) malloc(end - start + 1))) {
+        return -1;
+    }
+
+    for (out = key; start < end; start++) {
+        if (*start != '~') {
+            *out++ = *start;
+        } else if (start + 1 < end && (start[1] == '0' || start[1] == '1')) {
+            *out++ = *++start == '0' ? '~' : '/';
+        } else {
+            free(key);
+            return -1;
+        }
+    }
+    *out = 0;
+
+    for (i = path->nodes[parent].child; i >= 0; i = path->nodes[i].sibling) {
+        node = &path->nodes[i];
+        if (wildcard ? node->wildcard : !node->wildcard && !strcmp(node->key, key)) {
+            free(key);
+            return i;
+        }
+    }
+
+    if (path->size == path->capacity) {
+        grown = (Json_PathNode *) realloc(path->nodes, sizeof(Json_PathNode) * path->capacity * 2);
+        if (!grown) {
+            free(key);
+            return -1;
+        }
+        path->nodes = grown;
+        path->capacity *= 2;
+    }
+
+    node = &path->nodes[path->size];
+    node->wildcard = wildcard;
+    node->key = wildcard ? 0 : key;
+    node->index = wildcard ? -1 : segment_index(key);
+    node->child = -1;
+    node->sibling = -1;
+    node->end = -1;
+    if (wildcard) {
+        free(key);
+    }
+
+    /* appended, so that segments keep the order they were compiled in */
+    if (path->nodes[parent].child < 0) {
+        path->nodes[parent].child = path->size;
+    } else {
+        for (i = path->nodes[parent].child; path->nodes[i].sibling >= 0; i = path->nodes[i].sibling) {
+        }
+        path->nodes[i].sibling = path->size;
+    }
+
+    return path->size++;
+}
+
+static int add_pointer(Json_Path *path, int pointer, const char *text) {
+    const char *end;
+    int node = 0;
+
+    if (*text && *text != '/') {
+        return 0;
+    }
+
+    while (*text) {
+        text++;
+        end = strchr(text, '/');
+        if (!end) {
+            end = text + strlen(text);
+        }
+
+        if ((node = add_segment(path, node, text, end)) < 0) {
+            return 0;
+        }
+        text = end;
+    }
+
+    path->next_end[pointer] = path->nodes[node].end;
+    path->nodes[node].end = pointer;
+
+    return 1;
+}
+
+Json_Path *Json_PathCompileSet(const char *const *pointers, int count, int case_sensitive) {
+    Json_Path *path = (Json_Path *) malloc(sizeof(Json_Path));
+    int i;
+
+    if (!path) {
+        return 0;
+    }
+
+    path->count = count;
+    path->case_sensitive = case_sensitive;
+    path->size = 1;
+    path->capacity = 8;
+    path->nodes = (Json_PathNode *) malloc(sizeof(Json_PathNode) * path->capacity);
+    path->next_end = (int *) malloc(sizeof(int) * (count ? count : 1));
+    if (!path->nodes || !path->next_end) {
+        free(path->nodes);
+        free(path->next_end);
+        free(path);
+        return 0;
+    }
+
+    memset(&path->nodes[0], 0, sizeof(Json_PathNode));
+    path->nodes[0].index = -1;
+    path->nodes[0].child = -1;
+    path->nodes[0].sibling = -1;
+    path->nodes[0].end = -1;
+
+    for (i = 0; i < count; i++) {
+        if (!add_pointer(path, i, pointers[i])) {
+            Json_PathDelete(path);
+            return 0;
+        }
+    }
+
+    return path;
+}
+
+Json_Path *Json_PathCompile(const char *pointer, int case_sensitive) {
+    return Json_PathCompileSet(&pointer, 1, case_sensitive);
+}
+
+void Json_PathDelete(Json_Path *path) {
+    int i;
+
+    if (!path) {
+        return;
+    }
+
+    for (i = 0; i < path->size; i++) {
+        free(path->nodes[i].key);
+    }
+    free(path->nodes);
+    free(path->next_end);
+    free(path);
+}
+
+int Json_PathCount(const Json_Path *path) {
+    return path->count;
+}
+
+/*
+ * The member or item a literal segment names, through the key index or the
+ * array offsets when item has one.
+ */
+static Json *lookup(const Json_Path *path, Json *item, const Json_PathNode *node) {
+    if ((item->type & 255) == Json_Array) {
+        return node->index >= 0 ? Json_GetArrayItem(item, node->index) : 0;
+    }
+
+    return path->case_sensitive ? Json_GetObjectItemCaseSensitive(item, node->key)
+                                : Json_GetObjectItem(item, node->key);
+}
+
+static int walk(Json_PathWalk *w, int n, Json *item) {
+    const Json_PathNode *nodes = w->path->nodes;
+    Json *c;
+    int pointer, type, i;
+
+    for (pointer = nodes[n].end; pointer >= 0; pointer = w->path->next_end[pointer]) {
+        w->matches++;
+        if (!w->callback(w->context, pointer, item)) {
+            return 0;
+        }
+    }
+
+    type = item->type & 255;
+    if (nodes[n].child < 0 || (type != Json_Array && type != Json_Object)) {
+        return 1;
+    }
+
+    for (i = nodes[n].child; i >= 0; i = nodes[i].sibling) {
+        if (nodes[i].wildcard) {
+            for (c = item->child; c; c = c->next) {
+                if (!walk(w, i, c)) {
+                    return 0;
+                }
+            }
+        } else if ((c = lookup(w->path, item, &nodes[i])) && !walk(w, i, c)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int Json_PathSelect(const Json_Path *path, Json *root, Json_PathCallback callback, void *context) {
+    Json_PathWalk w;
+
+    w.path = path;
+    w.callback = callback;
+    w.context = context;
+    w.matches = 0;
+    if (root) {
+        walk(&w, 0, root);
+    }
+
+    return w.matches;
+}
+
+static int find_first(void *context, int pointer, Json *item) {
+    (void) pointer;
+    *(Json **) context = item;
+
+    return 0;
+}
+
+Json *Json_PathFind(const Json_Path *path, Json *root) {
+    Json *item = 0;
+
+    Json_PathSelect(path, root, find_first, &item);
+
+    return item;
+}
+
+typedef struct {
+    Json **items;
+    int found;
+    int count;
+} Json_PathFirsts;
+
+static int find_each(void *context, int pointer, Json *item) {
+    Json_PathFirsts *firsts = (Json_PathFirsts *) context;
+
+    if (!firsts->items[pointer]) {
+        firsts->items[pointer] = item;
+        firsts->found++;
+    }
+
+    /* all found: the rest of the walk can't change anything */
+    return firsts->found < firsts->count;
+}
+
+int Json_PathFindEach(const Json_Path *path, Json *root, Json **items) {
+    Json_PathFirsts firsts;
+
+    memset(items, 0, sizeof(Json *) * path->count);
+    firsts.items = items;
+    firsts.found = 0;
+    firsts.count = path->count;
+    Json_PathSelect(path, root, find_each, &firsts);
+
+    return firsts.found;
+}
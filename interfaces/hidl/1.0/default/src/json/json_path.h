@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_PATH_H_
+#define _JSON_PATH_H_
+
+#include "json.h"
+
+/*
+ * Precompiled queries: JSON Pointers (RFC 6901) such as
+ *
+ *     /cpuset/0/config/1/cpu
+ *
+ * are split, unescaped (~0 is '~', ~1 is '/') and turned into numbers once,
+ * so finding them in a tree builds no strings. A segment that is exactly "*"
+ * matches every item of an array and every member of an object: with "*" in
+ * place of 0 and 1 above, the pointer finds every cpu of every config.
+ * "" is the root itself. Numeric segments index arrays and name members of
+ * objects, "-" (past the end of an array) never matches.
+ *
+ * Several pointers compiled together share their common prefixes and are
+ * all found in one walk of the tree.
+ */
+typedef struct Json_Path Json_Path;
+
+/*
+ * Called for each match, with the position of its pointer in the list given
+ * to Json_PathCompileSet (0 for Json_PathCompile).
+ * Return 0 to stop the walk.
+ */
+typedef int (*Json_PathCallback)(void *context, int pointer, Json *item);
+
+/*
+ * Members are looked up like Json_GetObjectItem, unless case_sensitive is
+ * set (Json_GetObjectItemCaseSensitive, what RFC 6901 asks for).
+ * Returns 0 on a malformed pointer (not starting with '/', or a '~' other
+ * than ~0 and ~1) or memory fail. Delete with Json_PathDelete.
+ */
+extern Json_Path *Json_PathCompile(const char *pointer, int case_sensitive);
+
+extern Json_Path *Json_PathCompileSet(const char *const *pointers, int count, int case_sensitive);
+
+extern void Json_PathDelete(Json_Path *path);
+
+/*
+ * Number of pointers the path was compiled from.
+ */
+extern int Json_PathCount(const Json_Path *path);
+
+/*
+ * Matches come depth first, the segments of each level in the order they
+ * were first compiled in; "*" goes through the items in document order.
+ * A literal segment finds the first member with that key only.
+ */
+
+/*
+ * The first match, 0 if there is none.
+ */
+extern Json *Json_PathFind(const Json_Path *path, Json *root);
+
+/*
+ * The first match of every pointer, in one walk: items[i] for pointer i,
+ * 0 when it has none. items holds Json_PathCount entries.
+ * Returns the number of pointers found.
+ */
+extern int Json_PathFindEach(const Json_Path *path, Json *root, Json **items);
+
+/*
+ * Every match of every pointer, in one walk.
+ * Returns the number of matches reported.
+ */
+extern int Json_PathSelect(const Json_Path *path, Json *root, Json_PathCallback callback, void *context);
+
+#endif
@@ -0,0 +1,789 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "json_reader.h"
+#include "json_binary.h"
+
+/* What the document expects next. */
+#define STATE_VALUE 0       /* a value: the root, after ':', after ',' in an array */
+#define STATE_FIRST_VALUE 1 /* after '[': a value or ']' */
+#define STATE_FIRST_KEY 2   /* after '{': a key or '}' */
+#define STATE_KEY 3         /* after ',' in an object */
+#define STATE_COLON 4       /* after a key */
+#define STATE_NEXT 5        /* after a value in an object or array: ',' or the closing bracket */
+#define STATE_DONE 6        /* the root value is complete */
+#define STATE_FAILED 7
+
+struct Json_Reader {
+    /* the source: fd, or text when fd is -1 */
+    int fd;
+    const char *text;
+    size_t text_len;
+    size_t text_pos;
+
+    /* unread input is buffer[pos, len), buffer[len] is always 0 */
+    char *buffer;
+    size_t size;
+    size_t pos;
+    size_t len;
+    int eof;
+
+    /* bytes dropped from the front of the buffer, for error offsets */
+    size_t offset;
+
+    int state;
+    int last;
+
+    /* inside Json_ReaderSkip: strings and numbers are delimited, not converted */
+    int skipping;
+
+    int depth;
+    char stack[JSON_READER_MAX_DEPTH];
+
+    /*
+     * Json_Binary documents: 1 once the magic was seen, 0 for text, -1 until
+     * the first event. Items left in each open container, JSON_BINARY_OPEN
+     * when it ends with a break byte instead, and the byte a string's 0
+     * terminator stands on, put back on the next event.
+     */
+    int binary;
+    uint64 remaining[JSON_READER_MAX_DEPTH];
+    size_t held_pos;
+    char held;
+    int holding;
+
+    Json item;
+
+    const char *error;
+    size_t error_offset;
+};
+
+Json_Reader *Json_ReaderCreate(size_t buffer_size) {
+    Json_Reader *reader = (Json_Reader *) malloc(sizeof(Json_Reader));
+    if (!reader) {
+        return 0;
+    }
+
+    memset(reader, 0, sizeof(Json_Reader));
+    reader->size = buffer_size ? buffer_size : JSON_READER_DEFAULT_BUFFER;
+    reader->buffer = (char *) malloc(reader->size + 1);
+    if (!reader->buffer) {
+        free(reader);
+        return 0;
+    }
+
+    Json_ReaderSetText(reader, "", 0);
+
+    return reader;
+}
+
+void Json_ReaderDestroy(Json_Reader *reader) {
+    if (!reader) {
+        return;
+    }
+
+    free(reader->buffer);
+    free(reader);
+}
+
+static void reset(Json_Reader *reader) {
+    reader->pos = 0;
+    reader->len = 0;
+    reader->buffer[0] = 0;
+    reader->eof = 0;
+    reader->offset = 0;
+    reader->state = STATE_VALUE;
+    reader->last = Json_EventEnd;
+    reader->skipping = 0;
+    reader->depth = 0;
+    reader->binary = -1;
+    reader->holding = 0;
+    reader->error = 0;
+    reader->error_offset = 0;
+    memset(&reader->item, 0, sizeof(Json));
+}
+
+void Json_ReaderSetFd(Json_Reader *reader, int fd) {
+    reader->fd = fd;
+    reader->text = 0;
+    reset(reader);
+}
+
+void Json_ReaderSetText(Json_Reader *reader, const char *text, size_t len) {
+    reader->fd = -1;
+    reader->text = text;
+    reader->text_len = len;
+    reader->text_pos = 0;
+    reset(reader);
+}
+
+static int fail(Json_Reader *reader, const char *error) {
+    if (reader->state != STATE_FAILED) {
+        reader->error = error;
+        reader->error_offset = reader->offset + reader->pos;
+        reader->state = STATE_FAILED;
+    }
+
+    return Json_EventError;
+}
+
+/*
+ * Move the unread input to the front of the buffer and read more behind it.
+ * Returns 0 when nothing could be added: end of input, read error (error is
+ * set), or a buffer full of a single token.
+ */
+static int fill(Json_Reader *reader) {
+    ssize_t n;
+
+    if (reader->pos) {
+        memmove(reader->buffer, reader->buffer + reader->pos, reader->len - reader->pos);
+        reader->offset += reader->pos;
+        reader->len -= reader->pos;
+        reader->pos = 0;
+    }
+
+    if (reader->eof || reader->len == reader->size) {
+        return 0;
+    }
+
+    if (reader->fd >= 0) {
+        do {
+            n = read(reader->fd, reader->buffer + reader->len, reader->size - reader->len);
+        } while (n < 0 && errno == EINTR);
+
+        if (n < 0) {
+            reader->eof = 1;
+            fail(reader, "read error");
+            return 0;
+        }
+    } else {
+        n = reader->text_len - reader->text_pos;
+        if ((size_t) n > reader->size - reader->len) {
+            n = reader->size - reader->len;
+        }
+        memcpy(reader->buffer + reader->len, reader->text + reader->text_pos, n);
+        reader->text_pos += n;
+    }
+
+    if (n == 0) {
+        reader->eof = 1;
+        return 0;
+    }
+
+    reader->len += n;
+    reader->buffer[reader->len] = 0;
+
+    return 1;
+}
+
+/*
+ * Skip whitespace, the same rule as skip() in json.c.
+ * Returns the next character, or -1 at the end of input.
+ */
+static int peek(Json_Reader *reader) {
+    for (;;) {
+        while (reader->pos < reader->len && (unsigned char) reader->buffer[reader->pos] <= 32) {
+            reader->pos++;
+        }
+
+        if (reader->pos < reader->len) {
+            return (unsigned char) reader->buffer[reader->pos];
+        }
+
+        if (!fill(reader)) {
+            return -1;
+        }
+    }
+}
+
+static int is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/*
+ * The string at pos: make sure it is in the buffer up to its closing quote,
+ * with every \u escape complete, then unescape it in place.
+ */
+static int read_string(Json_Reader *reader) {
+    size_t i = reader->pos + 1, scanned;
+    const char *end;
+    int escaped = 0;
+
+    for (;;) {
+        while (i < reader->len && reader->buffer[i] != '\"') {
+            if (reader->buffer[i] != '\\') {
+                i++;
+                continue;
+            }
+
+            escaped = 1;
+
+            if (i + 1 >= reader->len) {
+                break;
+            }
+
+            if (reader->buffer[i + 1] != 'u') {
+                i += 2;
+                continue;
+            }
+
+            if (i + 5 >= reader->len) {
+                break;
+            }
+
+            if (!is_hex(reader->buffer[i + 2]) || !is_hex(reader->buffer[i + 3])
+                || !is_hex(reader->buffer[i + 4]) || !is_hex(reader->buffer[i + 5])) {
+                reader->pos = i;
+                return fail(reader, "bad \\u escape");
+            }
+            i += 6;
+        }
+
+        if (i < reader->len && reader->buffer[i] == '\"') {
+            break;
+        }
+
+        scanned = i - reader->pos;
+        if (!fill(reader)) {
+            return fail(reader, reader->eof ? "unterminated string" : "string longer than the buffer");
+        }
+        i = reader->pos + scanned;
+    }
+
+    if (reader->skipping) {
+        reader->pos = i + 1;
+        return 1;
+    }
+
+    memset(&reader->item, 0, sizeof(Json));
+    if (!escaped) {
+        /* nothing to unescape: end it at the closing quote */
+        reader->buffer[i] = 0;
+        reader->item.type = Json_String;
+        reader->item.valuestring = reader->buffer + reader->pos + 1;
+        reader->pos = i + 1;
+        return 1;
+    }
+
+    end = Json_ParseStringInSitu(&reader->item, reader->buffer + reader->pos);
+    if (!end) {
+        return fail(reader, "bad string");
+    }
+
+    reader->pos = end - reader->buffer;
+
+    return 1;
+}
+
+static int is_scalar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+           || c == '-' || c == '+' || c == '.';
+}
+
+/*
+ * A number, true, false or null at pos.
+ */
+static int read_scalar(Json_Reader *reader) {
+    size_t i = reader->pos, scanned, len;
+    const char *token, *end;
+
+    for (;;) {
+        while (i < reader->len && is_scalar(reader->buffer[i])) {
+            i++;
+        }
+
+        if (i < reader->len || reader->eof) {
+            break;
+        }
+
+        scanned = i - reader->pos;
+        if (!fill(reader) && !reader->eof) {
+            return fail(reader, reader->error ? reader->error : "value longer than the buffer");
+        }
+        i = reader->pos + scanned;
+    }
+
+    if (reader->state == STATE_FAILED) {
+        return Json_EventError;
+    }
+
+    token = reader->buffer + reader->pos;
+    len = i - reader->pos;
+    if (reader->skipping && len && (*token == '-' || (*token >= '0' && *token <= '9'))) {
+        reader->pos = i;
+        return 1;
+    }
+
+    memset(&reader->item, 0, sizeof(Json));
+    if (len == 4 && !strncmp(token, "null", 4)) {
+        reader->item.type = Json_NULL;
+    } else if (len == 4 && !strncmp(token, "true", 4)) {
+        reader->item.type = Json_True;
+        reader->item.valueint = 1;
+    } else if (len == 5 && !strncmp(token, "false", 5)) {
+        reader->item.type = Json_False;
+    } else {
+        end = len ? Json_ParseNumber(&reader->item, token) : 0;
+        if (end != token + len) {
+            return fail(reader, "bad value");
+        }
+    }
+
+    reader->pos = i;
+
+    return 1;
+}
+
+static int event(Json_Reader *reader, int event) {
+    reader->last = event;
+
+    return event;
+}
+
+static int after_value(Json_Reader *reader) {
+    reader->state = reader->depth ? STATE_NEXT : STATE_DONE;
+
+    return event(reader, Json_EventValue);
+}
+
+static int open_container(Json_Reader *reader, char c) {
+    if (reader->depth == JSON_READER_MAX_DEPTH) {
+        return fail(reader, "nested too deep");
+    }
+
+    reader->stack[reader->depth++] = c;
+    reader->pos++;
+    if (c == '{') {
+        reader->state = STATE_FIRST_KEY;
+        return event(reader, Json_EventStartObject);
+    }
+
+    reader->state = STATE_FIRST_VALUE;
+    return event(reader, Json_EventStartArray);
+}
+
+static int close_container(Json_Reader *reader) {
+    char c = reader->stack[--reader->depth];
+    reader->pos++;
+    reader->state = reader->depth ? STATE_NEXT : STATE_DONE;
+
+    return event(reader, c == '{' ? Json_EventEndObject : Json_EventEndArray);
+}
+
+static int read_value(Json_Reader *reader) {
+    int c = peek(reader);
+
+    switch (c) {
+        case -1:
+            return fail(reader, reader->error ? reader->error : "unexpected end");
+
+        case '{':
+        case '[':
+            return open_container(reader, (char) c);
+
+        case '\"':
+            if (read_string(reader) != 1) {
+                return Json_EventError;
+            }
+            return after_value(reader);
+
+        default:
+            if (read_scalar(reader) != 1) {
+                return Json_EventError;
+            }
+            return after_value(reader);
+    }
+}
+
+static int read_key(Json_Reader *reader, int c) {
+    if (c != '\"') {
+        return fail(reader, reader->error ? reader->error : "expected a key");
+    }
+
+    if (read_string(reader) != 1) {
+        return Json_EventError;
+    }
+
+    reader->state = STATE_COLON;
+    return event(reader, Json_EventKey);
+}
+
+/*
+ * At least n unread bytes at pos. Returns 0 on failure, error set.
+ */
+static int need(Json_Reader *reader, size_t n) {
+    while (reader->len - reader->pos < n) {
+        if (!fill(reader)) {
+            fail(reader, reader->error ? reader->error
+                                       : reader->eof ? "unexpected end" : "value longer than the buffer");
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * The head of the binary item at pos: major type, and its argument in *arg,
+ * JSON_BINARY_OPEN for an indefinite length. *size is the size in bytes of
+ * the argument after the initial byte.
+ * Returns -1 on failure, error set.
+ */
+static int read_head(Json_Reader *reader, uint64 *arg, int *size) {
+    const unsigned char *p;
+    int info;
+
+    if (!need(reader, 1)) {
+        return -1;
+    }
+
+    p = (const unsigned char *) reader->buffer + reader->pos;
+    info = p[0] & 31;
+    *size = 0;
+    if (info < 24 || info == 31) {
+        *arg = info == 31 ? JSON_BINARY_OPEN : (uint64) info;
+        reader->pos++;
+        return p[0] >> 5;
+    }
+
+    if (info > 27) {
+        fail(reader, "bad binary head");
+        return -1;
+    }
+
+    *size = 1 << (info - 24);
+    if (!need(reader, 1 + *size)) {
+        return -1;
+    }
+
+    p = (const unsigned char *) reader->buffer + reader->pos;
+    for (*arg = 0, info = 1; info <= *size; info++) {
+        *arg = *arg << 8 | p[info];
+    }
+    reader->pos += 1 + *size;
+
+    return p[0] >> 5;
+}
+
+static void set_double(Json_Reader *reader, double d) {
+    reader->item.type = Json_Double;
+    reader->item.valuedouble = d;
+    reader->item.valueint = (d > -9223372036854775808.0 && d < 9223372036854775808.0) ? (uint64) (int64) d : 0;
+    reader->item.sign = 1;
+}
+
+/*
+ * The simple value or float that follows a major type 7 head.
+ */
+static int read_simple(Json_Reader *reader, uint64 arg, int size) {
+    if (size >= 2) {
+        set_double(reader, Json_BinaryFloat(arg, size));
+        return 1;
+    }
+
+    switch (arg) {
+        case 20:
+            reader->item.type = Json_False;
+            return 1;
+
+        case 21:
+            reader->item.type = Json_True;
+            reader->item.valueint = 1;
+            return 1;
+
+        case 22:
+        case 23:
+            /* null, undefined */
+            reader->item.type = Json_NULL;
+            return 1;
+    }
+
+    return fail(reader, "bad binary simple value");
+}
+
+/*
+ * A text string of len bytes at pos, 0 terminated in place: the byte under
+ * the terminator is held and put back on the next event.
+ */
+static int read_text(Json_Reader *reader, uint64 len) {
+    if (len == JSON_BINARY_OPEN) {
+        return fail(reader, "chunked strings are not supported");
+    }
+
+    if (len >= reader->size || !need(reader, (size_t) len)) {
+        return fail(reader, reader->error ? reader->error : "string longer than the buffer");
+    }
+
+    if (!reader->skipping) {
+        reader->held_pos = reader->pos + (size_t) len;
+        reader->held = reader->buffer[reader->held_pos];
+        reader->holding = 1;
+        reader->buffer[reader->held_pos] = 0;
+        reader->item.type = Json_String;
+        reader->item.valuestring = reader->buffer + reader->pos;
+    }
+    reader->pos += (size_t) len;
+
+    return 1;
+}
+
+static int binary_open(Json_Reader *reader, char c, uint64 count) {
+    if (reader->depth == JSON_READER_MAX_DEPTH) {
+        return fail(reader, "nested too deep");
+    }
+
+    reader->remaining[reader->depth] = count;
+    reader->stack[reader->depth++] = c;
+    reader->state = c == '{' ? STATE_KEY : STATE_VALUE;
+
+    return event(reader, c == '{' ? Json_EventStartObject : Json_EventStartArray);
+}
+
+static int binary_close(Json_Reader *reader) {
+    char c = reader->stack[--reader->depth];
+    reader->state = reader->depth ? (reader->stack[reader->depth - 1] == '{' ? STATE_KEY : STATE_VALUE)
+                                  : STATE_DONE;
+
+    return event(reader, c == '{' ? Json_EventEndObject : Json_EventEndArray);
+}
+
+static int binary_value(Json_Reader *reader) {
+    uint64 arg;
+    int major, size;
+
+    /* tags, the magic among them, say nothing the tree could keep */
+    while ((major = read_head(reader, &arg, &size)) == 6) {
+    }
+
+    memset(&reader->item, 0, sizeof(Json));
+    switch (major) {
+        case -1:
+            return Json_EventError;
+
+        case 0:
+            reader->item.type = Json_Int;
+            reader->item.valueint = arg;
+            reader->item.valuedouble = (double) arg;
+            reader->item.sign = 1;
+            break;
+
+        case 1:
+            /* -1 - arg */
+            if (arg > 9223372036854775807ULL) {
+                set_double(reader, -1.0 - (double) arg);
+                break;
+            }
+            reader->item.type = Json_Int;
+            reader->item.valueint = ~arg;
+            reader->item.valuedouble = -1.0 - (double) arg;
+            reader->item.sign = -1;
+            break;
+
+        case 3:
+            if (read_text(reader, arg) != 1) {
+                return Json_EventError;
+            }
+            break;
+
+        case 4:
+            return binary_open(reader, '[', arg);
+
+        case 5:
+            return binary_open(reader, '{', arg);
+
+        case 7:
+            if (arg == JSON_BINARY_OPEN) {
+                return fail(reader, "unexpected break");
+            }
+            if (read_simple(reader, arg, size) != 1) {
+                return Json_EventError;
+            }
+            break;
+
+        default:
+            return fail(reader, "byte strings are not supported");
+    }
+
+    reader->state = reader->depth ? (reader->stack[reader->depth - 1] == '{' ? STATE_KEY : STATE_VALUE)
+                                  : STATE_DONE;
+
+    return event(reader, Json_EventValue);
+}
+
+static int binary_next(Json_Reader *reader) {
+    uint64 *remaining;
+    uint64 arg;
+    int size;
+
+    if (reader->holding) {
+        reader->buffer[reader->held_pos] = reader->held;
+        reader->holding = 0;
+    }
+
+    switch (reader->state) {
+        case STATE_FAILED:
+            return Json_EventError;
+
+        case STATE_DONE:
+            return event(reader, Json_EventEnd);
+
+        case STATE_COLON:
+            return binary_value(reader);
+    }
+
+    if (!reader->depth) {
+        return binary_value(reader);
+    }
+
+    /* the next item of the open container, or its end */
+    remaining = &reader->remaining[reader->depth - 1];
+    if (*remaining == JSON_BINARY_OPEN) {
+        if (!need(reader, 1)) {
+            return Json_EventError;
+        }
+        if ((unsigned char) reader->buffer[reader->pos] == JSON_BINARY_BREAK) {
+            reader->pos++;
+            return binary_close(reader);
+        }
+    } else if ((*remaining)-- == 0) {
+        return binary_close(reader);
+    }
+
+    if (reader->state != STATE_KEY) {
+        return binary_value(reader);
+    }
+
+    if (read_head(reader, &arg, &size) != 3) {
+        return fail(reader, reader->error ? reader->error : "expected a key");
+    }
+
+    memset(&reader->item, 0, sizeof(Json));
+    if (read_text(reader, arg) != 1) {
+        return Json_EventError;
+    }
+
+    reader->state = STATE_COLON;
+    return event(reader, Json_EventKey);
+}
+
+/*
+ * Text or Json_Binary, by the first bytes of the document.
+ */
+static int detect(Json_Reader *reader) {
+    while (reader->len - reader->pos < JSON_BINARY_MAGIC_LEN && fill(reader)) {
+    }
+
+    reader->binary = Json_IsBinary(reader->buffer + reader->pos, reader->len - reader->pos);
+
+    return reader->binary;
+}
+
+int Json_ReaderNext(Json_Reader *reader) {
+    int c;
+
+    if (reader->binary > 0 || (reader->binary < 0 && detect(reader))) {
+        return binary_next(reader);
+    }
+
+    switch (reader->state) {
+        case STATE_FAILED:
+            return Json_EventError;
+
+        case STATE_DONE:
+            return event(reader, Json_EventEnd);
+
+        case STATE_COLON:
+            if (peek(reader) != ':') {
+                return fail(reader, reader->error ? reader->error : "expected ':'");
+            }
+            reader->pos++;
+            return read_value(reader);
+
+        case STATE_FIRST_KEY:
+            c = peek(reader);
+            if (c == '}') {
+                return close_container(reader);
+            }
+            return read_key(reader, c);
+
+        case STATE_KEY:
+            return read_key(reader, peek(reader));
+
+        case STATE_FIRST_VALUE:
+            if (peek(reader) == ']') {
+                return close_container(reader);
+            }
+            return read_value(reader);
+
+        case STATE_NEXT:
+            c = peek(reader);
+            if (c == ',') {
+                reader->pos++;
+                reader->state = reader->stack[reader->depth - 1] == '{' ? STATE_KEY : STATE_VALUE;
+                return Json_ReaderNext(reader);
+            }
+
+            if (c == (reader->stack[reader->depth - 1] == '{' ? '}' : ']')) {
+                return close_container(reader);
+            }
+            return fail(reader, reader->error ? reader->error : "expected ',' or a closing bracket");
+
+        default:
+            return read_value(reader);
+    }
+}
+
+const Json *Json_ReaderItem(const Json_Reader *reader) {
+    return &reader->item;
+}
+
+int Json_ReaderDepth(const Json_Reader *reader) {
+    return reader->depth;
+}
+
+int Json_ReaderSkip(Json_Reader *reader) {
+    int depth, ev = reader->last;
+
+    if (ev == Json_EventKey) {
+        ev = Json_ReaderNext(reader);
+    }
+
+    if (ev != Json_EventStartObject && ev != Json_EventStartArray) {
+        return ev;
+    }
+
+    depth = reader->depth;
+    reader->skipping = 1;
+    do {
+        ev = Json_ReaderNext(reader);
+    } while (ev > 0 && reader->depth >= depth);
+    reader->skipping = 0;
+
+    return ev;
+}
+
+const char *Json_ReaderGetError(const Json_Reader *reader, size_t *offset) {
+    if (offset) {
+        *offset = reader->error_offset;
+    }
+
+    return reader->error;
+}
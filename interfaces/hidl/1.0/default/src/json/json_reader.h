@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_READER_H_
+#define _JSON_READER_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+/*
+ * Default buffer size. A single key, string or number must fit in the
+ * buffer, the document as a whole may be any size.
+ */
+#define JSON_READER_DEFAULT_BUFFER 4096
+
+/*
+ * Objects and arrays nested deeper than this are an error.
+ */
+#define JSON_READER_MAX_DEPTH 64
+
+/* Json_ReaderNext events: */
+#define Json_EventError (-1)
+#define Json_EventEnd 0
+#define Json_EventStartObject 1
+#define Json_EventEndObject 2
+#define Json_EventStartArray 3
+#define Json_EventEndArray 4
+#define Json_EventKey 5
+#define Json_EventValue 6
+
+/*
+ * A pull parser: the document is read a chunk at a time into a fixed buffer
+ * and handed out one event at a time, no tree is built.
+ *
+ *     while ((event = Json_ReaderNext(reader)) > 0) {
+ *         item = Json_ReaderItem(reader);
+ *         ...
+ *     }
+ *
+ * Strings are unescaped in place inside the buffer, like Json_ParseInSitu.
+ */
+typedef struct Json_Reader Json_Reader;
+
+/*
+ * buffer_size 0 means JSON_READER_DEFAULT_BUFFER.
+ * Returns 0 on memory fail.
+ */
+extern Json_Reader *Json_ReaderCreate(size_t buffer_size);
+
+extern void Json_ReaderDestroy(Json_Reader *reader);
+
+/*
+ * Start a new document, read from fd as the events need it.
+ * fd is not closed by the reader.
+ */
+extern void Json_ReaderSetFd(Json_Reader *reader, int fd);
+
+/*
+ * Start a new document, copied from text as the events need it.
+ * text is not modified, and must stay alive until the document is read.
+ */
+extern void Json_ReaderSetText(Json_Reader *reader, const char *text, size_t len);
+
+/*
+ * The next event: Json_EventEnd once the root value is complete,
+ * Json_EventError on a syntax error, a read error, a key or value longer than
+ * the buffer, or nesting deeper than JSON_READER_MAX_DEPTH. Both are final.
+ */
+extern int Json_ReaderNext(Json_Reader *reader);
+
+/*
+ * The key (Json_EventKey, in valuestring) or the scalar (Json_EventValue:
+ * type, valuestring, valueint/sign, valuedouble) of the last event.
+ * Valid until the next call on reader.
+ */
+extern const Json *Json_ReaderItem(const Json_Reader *reader);
+
+/*
+ * Number of objects and arrays open around the next event.
+ */
+extern int Json_ReaderDepth(const Json_Reader *reader);
+
+/*
+ * Skip what the last event opened: the value of a key, or the rest of an
+ * object or array after its start event. Returns the last event skipped
+ * (Json_EventValue, Json_EventEndObject or Json_EventEndArray), or
+ * Json_EventEnd/Json_EventError.
+ * Strings and numbers inside are only delimited, not unescaped or converted.
+ */
+extern int Json_ReaderSkip(Json_Reader *reader);
+
+/*
+ * Why Json_ReaderNext failed, and at which byte of the document.
+ * Returns 0 when there was no error.
+ */
+extern const char *Json_ReaderGetError(const Json_Reader *reader, size_t *offset);
+
+#endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "json_scan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_SCAN_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SCAN_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define JSON_SCAN_NEON
+#endif
+
+#if defined(__PCLMUL__) && (defined(JSON_SCAN_AVX2) || defined(JSON_SCAN_SSE2))
+#include <wmmintrin.h>
+#endif
+
+#define BLOCK_SIZE 64
+
+/*
+ * Per 64 byte block classification, bit i stands for byte i of the block.
+ */
+typedef struct Json_Block {
+    uint64 quote;
+    uint64 backslash;
+    uint64 op;
+    uint64 space;
+} Json_Block;
+
+/*
+ * State carried from one block to the next.
+ */
+typedef struct Json_ScanState {
+    uint64 prev_escaped;
+    uint64 prev_in_string;
+    uint64 prev_scalar;
+} Json_ScanState;
+
+#if defined(JSON_SCAN_AVX2)
+
+const char *Json_ScanImpl() {
+    return "avx2";
+}
+
+static uint64 eq_mask(__m256i lo, __m256i hi, char c) {
+    __m256i v = _mm256_set1_epi8(c);
+    uint64 l = (uint32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v));
+    uint64 h = (uint32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v));
+    return l | (h << 32);
+}
+
+static void classify(const unsigned char *in, Json_Block *block) {
+    __m256i lo = _mm256_loadu_si256((const __m256i *) in);
+    __m256i hi = _mm256_loadu_si256((const __m256i *) (in + 32));
+    __m256i ws = _mm256_set1_epi8(' ');
+    uint64 l, h;
+
+    block->quote = eq_mask(lo, hi, '"');
+    block->backslash = eq_mask(lo, hi, '\\');
+    block->op = eq_mask(lo, hi, '{') | eq_mask(lo, hi, '}')
+                | eq_mask(lo, hi, '[') | eq_mask(lo, hi, ']')
+                | eq_mask(lo, hi, ':') | eq_mask(lo, hi, ',');
+
+    /* unsigned byte <= 32, the same rule as skip() */
+    l = (uint32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(lo, ws), lo));
+    h = (uint32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(hi, ws), hi));
+    block->space = l | (h << 32);
+}
+
+#elif defined(JSON_SCAN_SSE2)
+
+const char *Json_ScanImpl() {
+    return "sse2";
+}
+
+static uint64 eq_mask(const __m128i *v, char c) {
+    __m128i k = _mm_set1_epi8(c);
+    uint64 m0 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v[0], k));
+    uint64 m1 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v[1], k));
+    uint64 m2 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v[2], k));
+    uint64 m3 = (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(v[3], k));
+    return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
+}
+
+static void classify(const unsigned char *in, Json_Block *block) {
+    __m128i v[4];
+    __m128i ws = _mm_set1_epi8(' ');
+    uint64 space = 0;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        v[i] = _mm_loadu_si128((const __m128i *) (in + 16 * i));
+        /* unsigned byte <= 32, the same rule as skip() */
+        space |= (uint64) (uint16_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v[i], ws), v[i])) << (16 * i);
+    }
+
+    block->quote = eq_mask(v, '"');
+    block->backslash = eq_mask(v, '\\');
+    block->op = eq_mask(v, '{') | eq_mask(v, '}')
+                | eq_mask(v, '[') | eq_mask(v, ']')
+                | eq_mask(v, ':') | eq_mask(v, ',');
+    block->space = space;
+}
+
+#elif defined(JSON_SCAN_NEON)
+
+const char *Json_ScanImpl() {
+    return "neon";
+}
+
+/*
+ * There is no movemask on NEON: weight each lane by its bit and fold
+ * the four vectors together with pairwise adds.
+ */
+static uint64 to_bitmask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+    static const uint8_t weights[16] = {
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+            0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80
+    };
+    uint8x16_t bits = vld1q_u8(weights);
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, bits), vandq_u8(m1, bits));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, bits), vandq_u8(m3, bits));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+static uint64 eq_mask(const uint8x16_t *v, char c) {
+    uint8x16_t k = vdupq_n_u8((uint8_t) c);
+    return to_bitmask(vceqq_u8(v[0], k), vceqq_u8(v[1], k), vceqq_u8(v[2], k), vceqq_u8(v[3], k));
+}
+
+static void classify(const unsigned char *in, Json_Block *block) {
+    uint8x16_t v[4];
+    uint8x16_t ws = vdupq_n_u8(' ');
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        v[i] = vld1q_u8(in + 16 * i);
+    }
+
+    block->quote = eq_mask(v, '"');
+    block->backslash = eq_mask(v, '\\');
+    block->op = eq_mask(v, '{') | eq_mask(v, '}')
+                | eq_mask(v, '[') | eq_mask(v, ']')
+                | eq_mask(v, ':') | eq_mask(v, ',');
+    /* unsigned byte <= 32, the same rule as skip() */
+    block->space = to_bitmask(vcleq_u8(v[0], ws), vcleq_u8(v[1], ws), vcleq_u8(v[2], ws), vcleq_u8(v[3], ws));
+}
+
+#else
+
+const char *Json_ScanImpl() {
+    return "scalar";
+}
+
+static void classify(const unsigned char *in, Json_Block *block) {
+    int i;
+    memset(block, 0, sizeof(Json_Block));
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        uint64 bit = 1ULL << i;
+        switch (in[i]) {
+            case '"':
+                block->quote |= bit;
+                break;
+
+            case '\\':
+                block->backslash |= bit;
+                break;
+
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                block->op |= bit;
+                break;
+
+            default:
+                if (in[i] <= 32) {
+                    block->space |= bit;
+                }
+                break;
+        }
+    }
+}
+
+#endif
+
+/*
+ * Running xor from the lowest bit up: every bit between an opening quote
+ * (inclusive) and its closing quote (exclusive) ends up set.
+ */
+static uint64 prefix_xor(uint64 bits) {
+#if defined(__PCLMUL__) && (defined(JSON_SCAN_AVX2) || defined(JSON_SCAN_SSE2))
+    __m128i all_ones = _mm_set1_epi8((char) 0xFF);
+    __m128i result = _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long) bits), all_ones, 0);
+    return (uint64) _mm_cvtsi128_si64(result);
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+/*
+ * Mark the characters escaped by an odd run of backslashes.
+ * Runs starting on even and odd bits are separated with an add, the
+ * carry out of the block says whether the next block starts escaped.
+ */
+static uint64 find_escaped(uint64 backslash, Json_ScanState *state) {
+    const uint64 even_bits = 0x5555555555555555ULL;
+    uint64 follows_escape, odd_starts, even_sequences;
+
+    backslash &= ~state->prev_escaped;
+    follows_escape = (backslash << 1) | state->prev_escaped;
+    odd_starts = backslash & ~even_bits & ~follows_escape;
+    even_sequences = odd_starts + backslash;
+    state->prev_escaped = even_sequences < odd_starts ? 1 : 0;
+
+    return (even_bits ^ (even_sequences << 1)) & follows_escape;
+}
+
+static uint64 scan_block(const unsigned char *in, Json_ScanState *state) {
+    Json_Block block;
+    uint64 quote, in_string, scalar, scalar_start;
+
+    classify(in, &block);
+
+    quote = block.quote & ~find_escaped(block.backslash, state);
+    in_string = prefix_xor(quote) ^ state->prev_in_string;
+    state->prev_in_string = (uint64) ((int64) in_string >> 63);
+
+    scalar = ~(block.op | block.space | quote | in_string);
+    scalar_start = scalar & ~((scalar << 1) | state->prev_scalar);
+    state->prev_scalar = scalar >> 63;
+
+    return (block.op & ~in_string) | quote | scalar_start;
+}
+
+static uint32 *flatten(uint32 *out, uint32 base, uint64 tokens) {
+    while (tokens) {
+        *out++ = base + (uint32) __builtin_ctzll(tokens);
+        tokens &= tokens - 1;
+    }
+
+    return out;
+}
+
+int Json_BuildIndex(const char *value, size_t len, Json_Index *index) {
+    const unsigned char *in = (const unsigned char *) value;
+    unsigned char tail[BLOCK_SIZE];
+    Json_ScanState state;
+    uint32 *out;
+    size_t i = 0;
+
+    index->count = 0;
+    /* Scratch memory, not part of the document: bypass the Json hooks. */
+    index->positions = (uint32 *) malloc((len + BLOCK_SIZE) * sizeof(uint32));
+    if (!index->positions) {
+        return 0;
+    }
+
+    memset(&state, 0, sizeof(state));
+    out = index->positions;
+    for (; i + BLOCK_SIZE <= len; i += BLOCK_SIZE) {
+        out = flatten(out, (uint32) i, scan_block(in + i, &state));
+    }
+
+    if (i < len) {
+        /* Pad the last block with spaces, they never produce a token. */
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, in + i, len - i);
+        out = flatten(out, (uint32) i, scan_block(tail, &state));
+    }
+
+    index->count = out - index->positions;
+
+    /* Still inside a string: unterminated. */
+    return state.prev_in_string ? 0 : 1;
+}
+
+void Json_FreeIndex(Json_Index *index) {
+    if (index->positions) {
+        free(index->positions);
+        index->positions = 0;
+    }
+
+    index->count = 0;
+}
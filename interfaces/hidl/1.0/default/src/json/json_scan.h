@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_SCAN_H_
+#define _JSON_SCAN_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+/*
+ * Inputs shorter than this are parsed by the plain recursive descent,
+ * building the index would cost more than it saves.
+ */
+#define JSON_SCAN_MIN_LENGTH 64
+
+/*
+ * The structural index of a JSON text.
+ * positions holds, in input order, the offset of every structural
+ * character ({ } [ ] : ,) outside of strings, of both the opening and
+ * the closing quote of every string, and of the first character of
+ * every scalar (number, true, false, null).
+ */
+typedef struct Json_Index {
+    uint32 *positions;
+    size_t count;
+} Json_Index;
+
+/*
+ * Scan len bytes of value in 64 byte blocks (SSE2/AVX2/NEON when available,
+ * scalar otherwise) and fill index.
+ * Returns 1 on success, 0 on memory fail or an unterminated string.
+ * Call Json_FreeIndex when finished, even on failure.
+ */
+extern int Json_BuildIndex(const char *value, size_t len, Json_Index *index);
+
+extern void Json_FreeIndex(Json_Index *index);
+
+/*
+ * Name of the block classifier compiled in: "avx2", "sse2", "neon" or "scalar".
+ */
+extern const char *Json_ScanImpl();
+
+#endif
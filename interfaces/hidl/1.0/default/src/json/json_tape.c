@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "json_tape.h"
+#include "json_reader.h"
+
+#define TAPE_ENTRY(type, payload) (((uint64) (type) << 56) | (payload))
+
+/*
+ * Counts from here on are not kept, they are walked.
+ */
+#define TAPE_COUNT_MAX 0xFFFFFF
+
+#define TAPE_MIN_ENTRIES 64
+#define TAPE_MIN_STRINGS 256
+
+static Json_Tape *tape_create(size_t entries, size_t strings) {
+    Json_Tape *tape = (Json_Tape *) malloc(sizeof(Json_Tape));
+    if (!tape) {
+        return 0;
+    }
+
+    memset(tape, 0, sizeof(Json_Tape));
+    tape->capacity = entries > TAPE_MIN_ENTRIES ? entries : TAPE_MIN_ENTRIES;
+    tape->room = strings > TAPE_MIN_STRINGS ? strings : TAPE_MIN_STRINGS;
+    tape->entries = (uint64 *) malloc(tape->capacity * sizeof(uint64));
+    tape->strings = (char *) malloc(tape->room);
+    if (!tape->entries || !tape->strings) {
+        Json_TapeDelete(tape);
+        return 0;
+    }
+
+    return tape;
+}
+
+void Json_TapeDelete(Json_Tape *tape) {
+    if (!tape) {
+        return;
+    }
+
+    free(tape->entries);
+    free(tape->strings);
+    free(tape);
+}
+
+/*
+ * Room for n more entries. Positions must fit the 32 bits of a container.
+ */
+static int tape_reserve(Json_Tape *tape, size_t n) {
+    uint64 *grown;
+    size_t capacity = tape->capacity;
+
+    if (tape->count + n <= capacity) {
+        return 1;
+    }
+
+    while (capacity < tape->count + n) {
+        capacity *= 2;
+    }
+
+    if (capacity > 0xFFFFFFFFULL || !(grown = (uint64 *) realloc(tape->entries, capacity * sizeof(uint64)))) {
+        return 0;
+    }
+
+    tape->entries = grown;
+    tape->capacity = capacity;
+    return 1;
+}
+
+static int tape_put(Json_Tape *tape, uint64 entry) {
+    if (!tape_reserve(tape, 1)) {
+        return 0;
+    }
+
+    tape->entries[tape->count++] = entry;
+    return 1;
+}
+
+static int tape_put_string(Json_Tape *tape, int type, const char *str) {
+    size_t len = strlen(str), need = tape->length + sizeof(uint32) + len + 1, room = tape->room;
+    uint32 len32 = (uint32) len;
+    char *grown;
+
+    if (len > 0xFFFFFFFFULL) {
+        return 0;
+    }
+
+    if (need > room) {
+        while (room < need) {
+            room *= 2;
+        }
+
+        if (!(grown = (char *) realloc(tape->strings, room))) {
+            return 0;
+        }
+
+        tape->strings = grown;
+        tape->room = room;
+    }
+
+    if (!tape_put(tape, TAPE_ENTRY(type, tape->length))) {
+        return 0;
+    }
+
+    memcpy(tape->strings + tape->length, &len32, sizeof(uint32));
+    memcpy(tape->strings + tape->length + sizeof(uint32), str, len + 1);
+    tape->length = need;
+    return 1;
+}
+
+/*
+ * A scalar: strings, numbers (two entries), false, true and null.
+ */
+static int tape_put_scalar(Json_Tape *tape, const Json *item) {
+    int type = item->type & 255;
+    uint64 bits;
+
+    tape->values++;
+    switch (type) {
+        case Json_String:
+            return tape_put_string(tape, Json_String, item->valuestring ? item->valuestring : "");
+
+        case Json_Int:
+            bits = item->valueint;
+            break;
+
+        case Json_Double:
+            memcpy(&bits, &item->valuedouble, sizeof(uint64));
+            break;
+
+        default:
+            return tape_put(tape, TAPE_ENTRY(type, 0));
+    }
+
+    if (!tape_reserve(tape, 2)) {
+        return 0;
+    }
+
+    tape->entries[tape->count++] = TAPE_ENTRY(type, item->sign == -1);
+    tape->entries[tape->count++] = bits;
+    return 1;
+}
+
+/*
+ * The container opened at position start ends here, with count items.
+ */
+static void tape_close(Json_Tape *tape, size_t start, size_t count) {
+    uint64 type = tape->entries[start] >> 56;
+    if (count > TAPE_COUNT_MAX) {
+        count = TAPE_COUNT_MAX;
+    }
+
+    tape->entries[start] = (type << 56) | ((uint64) count << 32) | (uint64) tape->count;
+}
+
+static int tape_put_tree(Json_Tape *tape, Json *item) {
+    int type = item->type & 255;
+    size_t start = tape->count, count = 0;
+    Json *child;
+
+    if (type != Json_Array && type != Json_Object) {
+        return tape_put_scalar(tape, item);
+    }
+
+    tape->values++;
+    if (!tape_put(tape, TAPE_ENTRY(type, 0))) {
+        return 0;
+    }
+
+    for (child = item->child; child; child = child->next, count++) {
+        if (type == Json_Object && !tape_put_string(tape, JSON_TAPE_KEY, child->string ? child->string : "")) {
+            return 0;
+        }
+
+        if (!tape_put_tree(tape, child)) {
+            return 0;
+        }
+    }
+
+    tape_close(tape, start, count);
+    return 1;
+}
+
+Json_Tape *Json_TapeFromTree(Json *item) {
+    Json_Tape *tape;
+
+    if (!item || !(tape = tape_create(0, 0))) {
+        return 0;
+    }
+
+    if (!tape_put_tree(tape, item)) {
+        Json_TapeDelete(tape);
+        return 0;
+    }
+
+    return tape;
+}
+
+/*
+ * The containers open around the next event, with their items so far.
+ */
+typedef struct Json_TapeLevel {
+    size_t start;
+    size_t count;
+} Json_TapeLevel;
+
+static int tape_read(Json_Tape *tape, Json_Reader *reader) {
+    Json_TapeLevel levels[JSON_READER_MAX_DEPTH];
+    int depth = 0, event;
+
+    while ((event = Json_ReaderNext(reader)) > 0) {
+        /* a key is counted with its value, a value closes nothing */
+        if (depth && event != Json_EventEndObject && event != Json_EventEndArray && event != Json_EventKey) {
+            levels[depth - 1].count++;
+        }
+
+        switch (event) {
+            case Json_EventStartObject:
+            case Json_EventStartArray:
+                levels[depth].start = tape->count;
+                levels[depth++].count = 0;
+                tape->values++;
+                if (!tape_put(tape, TAPE_ENTRY(event == Json_EventStartObject ? Json_Object : Json_Array, 0))) {
+                    return 0;
+                }
+                break;
+
+            case Json_EventEndObject:
+            case Json_EventEndArray:
+                depth--;
+                tape_close(tape, levels[depth].start, levels[depth].count);
+                break;
+
+            case Json_EventKey:
+                if (!tape_put_string(tape, JSON_TAPE_KEY, Json_ReaderItem(reader)->valuestring)) {
+                    return 0;
+                }
+                break;
+
+            default:
+                if (!tape_put_scalar(tape, Json_ReaderItem(reader))) {
+                    return 0;
+                }
+                break;
+        }
+    }
+
+    return event == Json_EventEnd;
+}
+
+Json_Tape *Json_TapeParse(const char *value, size_t len) {
+    Json_Tape *tape;
+    Json_Reader *reader;
+    int ok;
+
+    /* the whole text fits the buffer: any string in it does. About one entry per 8 bytes of text */
+    if (!(reader = Json_ReaderCreate(len + 1 > JSON_READER_DEFAULT_BUFFER ? len + 1 : 0))) {
+        return 0;
+    }
+
+    if (!(tape = tape_create(len / 8, len / 2))) {
+        Json_ReaderDestroy(reader);
+        return 0;
+    }
+
+    Json_ReaderSetText(reader, value, len);
+    ok = tape_read(tape, reader) && tape->count;
+    Json_ReaderDestroy(reader);
+    if (!ok) {
+        Json_TapeDelete(tape);
+        return 0;
+    }
+
+    return tape;
+}
+
+void Json_TapeGetStats(const Json_Tape *tape, Json_TapeStats *stats) {
+    stats->entries = tape->count;
+    stats->string_bytes = tape->length;
+    stats->values = tape->values;
+}
+
+int Json_TapeGetArraySize(const Json_Tape *tape, size_t at) {
+    uint64 entry = tape->entries[at];
+    int type = JSON_TAPE_TYPE(entry), count = 0;
+    size_t c;
+
+    if (type != Json_Array && type != Json_Object) {
+        return 0;
+    }
+
+    if (JSON_TAPE_COUNT(entry) < TAPE_COUNT_MAX) {
+        return (int) JSON_TAPE_COUNT(entry);
+    }
+
+    for (c = Json_TapeChild(tape, at); c != JSON_TAPE_NONE; c = Json_TapeNext(tape, at, c)) {
+        count++;
+    }
+
+    return count;
+}
+
+size_t Json_TapeGetObjectItem(const Json_Tape *tape, size_t at, const char *string, int case_sensitive) {
+    uint64 entry = tape->entries[at];
+    size_t c, end = JSON_TAPE_END(entry), len = strlen(string);
+    const char *key;
+    uint32 keylen;
+
+    if (JSON_TAPE_TYPE(entry) != Json_Object) {
+        return JSON_TAPE_NONE;
+    }
+
+    /* keys of another length never match, the case of ASCII letters changes no length */
+    for (c = at + 1; c < end; c = Json_TapeSkip(tape, c + 1)) {
+        key = Json_TapeString(tape, c, &keylen);
+        if (keylen == len && (case_sensitive ? !memcmp(key, string, len) : !strcasecmp(key, string))) {
+            return c + 1;
+        }
+    }
+
+    return JSON_TAPE_NONE;
+}
+
+Json *Json_TapeToTree(const Json_Tape *tape, size_t at) {
+    Json item, *tree, *child;
+    size_t c;
+    int type = JSON_TAPE_TYPE(tape->entries[at]);
+
+    Json_TapeGetItem(tape, at, &item);
+    switch (type) {
+        case Json_Array:
+        case Json_Object:
+            if (!(tree = type == Json_Array ? Json_CreateArray() : Json_CreateObject())) {
+                return 0;
+            }
+
+            for (c = Json_TapeChild(tape, at); c != JSON_TAPE_NONE; c = Json_TapeNext(tape, at, c)) {
+                if (!(child = Json_TapeToTree(tape, c))) {
+                    Json_Delete(tree);
+                    return 0;
+                }
+
+                if (type == Json_Array) {
+                    Json_AddItemToArray(tree, child);
+                } else {
+                    Json_AddItemToObject(tree, Json_TapeKey(tape, c), child);
+                    if (!child->string) {
+                        Json_Delete(tree);
+                        return 0;
+                    }
+                }
+            }
+            return tree;
+
+        case Json_String:
+            return Json_CreateString(item.valuestring);
+
+        case Json_Int:
+            /* the parser's pair: valueint in two's complement, valuedouble signed */
+            if ((tree = Json_CreateInt(item.valueint, item.sign))) {
+                tree->valuedouble = item.valuedouble;
+            }
+            return tree;
+
+        case Json_Double:
+            return Json_CreateDouble(item.valuedouble, item.sign);
+    }
+
+    return type == Json_NULL ? Json_CreateNull() : Json_CreateBool(type == Json_True);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _JSON_TAPE_H_
+#define _JSON_TAPE_H_
+
+#include <stddef.h>
+#include <string.h>
+
+#include "json.h"
+
+/*
+ * A document laid out flat ("tape"), read-only: one array of 64-bit entries
+ * in document order, and one buffer holding every string. Walking it reads
+ * memory front to back, where a tree of Json nodes chases pointers across
+ * the heap, and each value costs 8 bytes (16 for a number, 8 more for the
+ * key of a member) instead of a Json node.
+ *
+ * A value is known by its position on the tape, the root is at 0. The top
+ * byte of an entry is its type (json.h, or JSON_TAPE_KEY), the rest:
+ *
+ *     Json_Array, Json_Object   bits 0-31 the position past the last item,
+ *                               bits 32-55 the number of items (members)
+ *     Json_Int, Json_Double     bit 0 set when negative, the next entry
+ *                               holds valueint or the bits of valuedouble
+ *     Json_String, JSON_TAPE_KEY  offset of the string in the buffer: a
+ *                               32-bit length, then the text and a 0
+ *     Json_False, Json_True, Json_NULL  nothing
+ *
+ * Every member of an object is its key entry followed by its value, so
+ * skipping any value is one step, and a container is skipped whole.
+ * Members are looked up by walking them: the tape has no key index.
+ */
+#define JSON_TAPE_KEY 8
+
+/*
+ * No such position.
+ */
+#define JSON_TAPE_NONE ((size_t) -1)
+
+/*
+ * The fields of an entry, as laid out above.
+ */
+#define JSON_TAPE_TYPE(entry) ((int) ((entry) >> 56))
+#define JSON_TAPE_END(entry) ((size_t) ((entry) & 0xFFFFFFFFULL))
+#define JSON_TAPE_COUNT(entry) ((uint32) (((entry) >> 32) & 0xFFFFFF))
+#define JSON_TAPE_OFFSET(entry) ((size_t) ((entry) & 0xFFFFFFFFFFFFFFULL))
+
+/*
+ * Open so that the readers below inline: a walk is a few of them per
+ * value, a call each would cost more than the entries they read.
+ * Only json_tape.c writes it.
+ */
+typedef struct Json_Tape {
+    /* count entries in use of capacity */
+    uint64 *entries;
+    size_t count;
+    size_t capacity;
+
+    /* length bytes of strings in use of room */
+    char *strings;
+    size_t length;
+    size_t room;
+
+    size_t values;
+} Json_Tape;
+
+typedef struct Json_TapeStats {
+    /* entries, and bytes of the string buffer */
+    size_t entries;
+    size_t string_bytes;
+
+    /* values on the tape: what a tree of the same document has nodes for */
+    size_t values;
+} Json_TapeStats;
+
+/*
+ * len bytes of JSON text straight onto a tape, through a Json_Reader: no
+ * tree in between. Nesting is limited to JSON_READER_MAX_DEPTH.
+ * Returns 0 on a syntax error or memory fail. Delete with Json_TapeDelete.
+ */
+extern Json_Tape *Json_TapeParse(const char *value, size_t len);
+
+/*
+ * A tape of the tree item. Returns 0 on memory fail.
+ */
+extern Json_Tape *Json_TapeFromTree(Json *item);
+
+/*
+ * The value at position at as a tree of its own. Returns 0 on memory fail.
+ */
+extern Json *Json_TapeToTree(const Json_Tape *tape, size_t at);
+
+extern void Json_TapeDelete(Json_Tape *tape);
+
+extern void Json_TapeGetStats(const Json_Tape *tape, Json_TapeStats *stats);
+
+/*
+ * Items of the array (members of the object) at position at, 0 for scalars.
+ */
+extern int Json_TapeGetArraySize(const Json_Tape *tape, size_t at);
+
+/*
+ * The value of member "string" of the object at position at, JSON_TAPE_NONE
+ * if there is none or at is not an object. Keys match like
+ * Json_GetObjectItem, unless case_sensitive is set.
+ */
+extern size_t Json_TapeGetObjectItem(const Json_Tape *tape, size_t at, const char *string, int case_sensitive);
+
+/*
+ * The type of the value at position at (json.h).
+ */
+static inline int Json_TapeType(const Json_Tape *tape, size_t at) {
+    return JSON_TAPE_TYPE(tape->entries[at]);
+}
+
+/*
+ * The position right after the value at position at, and all it holds.
+ */
+static inline size_t Json_TapeSkip(const Json_Tape *tape, size_t at) {
+    uint64 entry = tape->entries[at];
+
+    switch (JSON_TAPE_TYPE(entry)) {
+        case Json_Array:
+        case Json_Object:
+            return JSON_TAPE_END(entry);
+
+        case Json_Int:
+        case Json_Double:
+            return at + 2;
+    }
+
+    return at + 1;
+}
+
+/*
+ * The text of the Json_String (or JSON_TAPE_KEY) at position at, inside the
+ * tape, its length in *len: no strlen needed.
+ */
+static inline const char *Json_TapeString(const Json_Tape *tape, size_t at, uint32 *len) {
+    const char *str = tape->strings + JSON_TAPE_OFFSET(tape->entries[at]);
+    memcpy(len, str, sizeof(uint32));
+    return str + sizeof(uint32);
+}
+
+/*
+ * valueint of the number at position at, as Json_TapeGetItem gives it.
+ */
+static inline uint64 Json_TapeGetInt(const Json_Tape *tape, size_t at) {
+    double d;
+
+    if (JSON_TAPE_TYPE(tape->entries[at]) == Json_Int) {
+        return tape->entries[at + 1];
+    }
+
+    memcpy(&d, &tape->entries[at + 1], sizeof(double));
+    return (d > -9223372036854775808.0 && d < 9223372036854775808.0) ? (uint64) (int64) d : 0;
+}
+
+/*
+ * The scalar at position at into item: type, valuestring (inside the tape),
+ * valueint/sign, valuedouble. For an array or an object only the type.
+ * Nothing is allocated, item only links into the tape.
+ */
+static inline void Json_TapeGetItem(const Json_Tape *tape, size_t at, Json *item) {
+    uint64 entry = tape->entries[at];
+    uint32 len;
+
+    memset(item, 0, sizeof(Json));
+    item->type = JSON_TAPE_TYPE(entry);
+    item->sign = (entry & 1) && (item->type == Json_Int || item->type == Json_Double) ? -1 : 1;
+    switch (item->type) {
+        case Json_String:
+            item->valuestring = (char *) Json_TapeString(tape, at, &len);
+            break;
+
+        /* the other number of the pair, the way the parser makes it */
+        case Json_Int:
+            item->valueint = tape->entries[at + 1];
+            item->valuedouble = item->sign == -1 ? -(double) (0 - item->valueint) : (double) item->valueint;
+            break;
+
+        case Json_Double:
+            memcpy(&item->valuedouble, &tape->entries[at + 1], sizeof(double));
+            item->valueint = Json_TapeGetInt(tape, at);
+            break;
+    }
+}
+
+/*
+ * Walking the items of the array (values of the object) at position parent:
+ * the first, and the one after the item at position at, JSON_TAPE_NONE past
+ * the last one.
+ */
+static inline size_t Json_TapeChild(const Json_Tape *tape, size_t parent) {
+    uint64 entry = tape->entries[parent];
+    int type = JSON_TAPE_TYPE(entry);
+
+    if ((type != Json_Array && type != Json_Object) || JSON_TAPE_END(entry) == parent + 1) {
+        return JSON_TAPE_NONE;
+    }
+
+    return type == Json_Object ? parent + 2 : parent + 1;
+}
+
+static inline size_t Json_TapeNext(const Json_Tape *tape, size_t parent, size_t at) {
+    uint64 entry = tape->entries[parent];
+    size_t next = Json_TapeSkip(tape, at);
+
+    if (next >= JSON_TAPE_END(entry)) {
+        return JSON_TAPE_NONE;
+    }
+
+    return JSON_TAPE_TYPE(entry) == Json_Object ? next + 1 : next;
+}
+
+/*
+ * Item number "item" of the array at position at, JSON_TAPE_NONE if there
+ * is no such item or at is not an array.
+ */
+static inline size_t Json_TapeGetArrayItem(const Json_Tape *tape, size_t at, int item) {
+    size_t c;
+
+    if (JSON_TAPE_TYPE(tape->entries[at]) != Json_Array || item < 0) {
+        return JSON_TAPE_NONE;
+    }
+
+    for (c = Json_TapeChild(tape, at); c != JSON_TAPE_NONE && item > 0; c = Json_TapeNext(tape, at, c)) {
+        item--;
+    }
+
+    return c;
+}
+
+/*
+ * The key of the member whose value is at position at, which must be a
+ * member of an object (Json_TapeGetObjectItem, Json_TapeChild/Json_TapeNext
+ * on an object). Json_TapeString at at - 1 has it with its length.
+ */
+static inline const char *Json_TapeKey(const Json_Tape *tape, size_t at) {
+    uint32 len;
+    return Json_TapeString(tape, at - 1, &len);
+}
+
+#endif
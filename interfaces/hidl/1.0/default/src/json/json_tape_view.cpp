@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "json_tape_view.h"
+
+JsonTape::JsonTape(const std::string &strJson) : m_pTape(NULL) {
+    Parse(strJson);
+}
+
+JsonTape::JsonTape(const JsonObject &oJsonObject) : m_pTape(NULL) {
+    Json *pJsonData = oJsonObject.View().GetJson();
+    if (pJsonData != NULL && (m_pTape = Json_TapeFromTree(pJsonData)) == NULL) {
+        m_strErrMsg = "out of memory!";
+    }
+}
+
+JsonTape::JsonTape(JsonTape &&oTape) : m_pTape(oTape.m_pTape), m_strErrMsg(std::move(oTape.m_strErrMsg)) {
+    oTape.m_pTape = NULL;
+}
+
+JsonTape::~JsonTape() {
+    Json_TapeDelete(m_pTape);
+}
+
+JsonTape &JsonTape::operator=(JsonTape &&oTape) {
+    if (this != &oTape) {
+        Json_TapeDelete(m_pTape);
+        m_pTape = oTape.m_pTape;
+        m_strErrMsg = std::move(oTape.m_strErrMsg);
+        oTape.m_pTape = NULL;
+    }
+
+    return (*this);
+}
+
+bool JsonTape::Parse(const std::string &strJson) {
+    Clear();
+
+    m_pTape = Json_TapeParse(strJson.c_str(), strJson.size());
+    if (m_pTape == NULL) {
+        m_strErrMsg = "prase json string error";
+        return (false);
+    }
+
+    return (true);
+}
+
+void JsonTape::Clear() {
+    Json_TapeDelete(m_pTape);
+    m_pTape = NULL;
+}
+
+JsonTapeView JsonTape::View(bool bCaseSensitive) const {
+    return (JsonTapeView(m_pTape, 0, bCaseSensitive));
+}
+
+std::string JsonTape::ToString() const {
+    return (View().ToString());
+}
+
+std::string JsonTapeView::ToString() const {
+    std::string strJsonData = "";
+    if (IsEmpty()) {
+        return (strJsonData);
+    }
+
+    // printing goes through a tree: the printer is written for nodes
+    Json *pJsonData = Json_TapeToTree(m_pTape, m_uiAt);
+    char *pJsonString = pJsonData != NULL ? Json_PrintUnformatted(pJsonData) : NULL;
+    if (pJsonString != NULL) {
+        strJsonData = pJsonString;
+        free(pJsonString);
+    }
+    Json_Delete(pJsonData);
+
+    return (strJsonData);
+}
+
+size_t JsonTapeView::GetItem(const char *szKey) const {
+    if (IsEmpty()) {
+        return (JSON_TAPE_NONE);
+    }
+
+    return (Json_TapeGetObjectItem(m_pTape, m_uiAt, szKey, m_bCaseSensitive));
+}
+
+size_t JsonTapeView::GetItem(int iWhich) const {
+    if (IsEmpty()) {
+        return (JSON_TAPE_NONE);
+    }
+
+    return (Json_TapeGetArrayItem(m_pTape, m_uiAt, iWhich));
+}
+
+bool JsonTapeView::Load(size_t uiAt, Json &oItem) const {
+    if (uiAt == JSON_TAPE_NONE) {
+        return (false);
+    }
+
+    Json_TapeGetItem(m_pTape, uiAt, &oItem);
+    return (true);
+}
+
+JsonTapeView JsonTapeView::operator[](const char *szKey) const {
+    return (JsonTapeView(m_pTape, GetItem(szKey), m_bCaseSensitive));
+}
+
+std::string JsonTapeView::operator()(const char *szKey) const {
+    return (JsonTapeView(m_pTape, GetItem(szKey), m_bCaseSensitive).ToValueString());
+}
+
+bool JsonTapeView::Get(const char *szKey, JsonTapeView &oJsonView) const {
+    size_t uiAt = GetItem(szKey);
+    if (uiAt == JSON_TAPE_NONE) {
+        return (false);
+    }
+
+    oJsonView = JsonTapeView(m_pTape, uiAt, m_bCaseSensitive);
+    return (true);
+}
+
+bool JsonTapeView::Get(const char *szKey, std::string &strValue) const {
+    return (operator[](szKey).ToValue(strValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, int32 &iValue) const {
+    return (operator[](szKey).ToValue(iValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, uint32 &uiValue) const {
+    return (operator[](szKey).ToValue(uiValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, int64 &llValue) const {
+    return (operator[](szKey).ToValue(llValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, uint64 &ullValue) const {
+    return (operator[](szKey).ToValue(ullValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, bool &bValue) const {
+    return (operator[](szKey).ToValue(bValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, float &fValue) const {
+    return (operator[](szKey).ToValue(fValue));
+}
+
+bool JsonTapeView::Get(const char *szKey, double &dValue) const {
+    return (operator[](szKey).ToValue(dValue));
+}
+
+bool JsonTapeView::IsNull(const char *szKey) const {
+    size_t uiAt = GetItem(szKey);
+    return (uiAt != JSON_TAPE_NONE && Json_TapeType(m_pTape, uiAt) == Json_NULL);
+}
+
+int JsonTapeView::GetArraySize() const {
+    if (!IsArray()) {
+        return (0);
+    }
+
+    return (Json_TapeGetArraySize(m_pTape, m_uiAt));
+}
+
+JsonTapeView JsonTapeView::operator[](int iWhich) const {
+    return (JsonTapeView(m_pTape, GetItem(iWhich), m_bCaseSensitive));
+}
+
+std::string JsonTapeView::operator()(int iWhich) const {
+    return (JsonTapeView(m_pTape, GetItem(iWhich), m_bCaseSensitive).ToValueString());
+}
+
+bool JsonTapeView::Get(int iWhich, JsonTapeView &oJsonView) const {
+    size_t uiAt = GetItem(iWhich);
+    if (uiAt == JSON_TAPE_NONE) {
+        return (false);
+    }
+
+    oJsonView = JsonTapeView(m_pTape, uiAt, m_bCaseSensitive);
+    return (true);
+}
+
+bool JsonTapeView::Get(int iWhich, std::string &strValue) const {
+    return (operator[](iWhich).ToValue(strValue));
+}
+
+bool JsonTapeView::Get(int iWhich, int32 &iValue) const {
+    return (operator[](iWhich).ToValue(iValue));
+}
+
+bool JsonTapeView::Get(int iWhich, uint32 &uiValue) const {
+    return (operator[](iWhich).ToValue(uiValue));
+}
+
+bool JsonTapeView::Get(int iWhich, int64 &llValue) const {
+    return (operator[](iWhich).ToValue(llValue));
+}
+
+bool JsonTapeView::Get(int iWhich, uint64 &ullValue) const {
+    return (operator[](iWhich).ToValue(ullValue));
+}
+
+bool JsonTapeView::Get(int iWhich, bool &bValue) const {
+    return (operator[](iWhich).ToValue(bValue));
+}
+
+bool JsonTapeView::Get(int iWhich, float &fValue) const {
+    return (operator[](iWhich).ToValue(fValue));
+}
+
+bool JsonTapeView::Get(int iWhich, double &dValue) const {
+    return (operator[](iWhich).ToValue(dValue));
+}
+
+bool JsonTapeView::IsNull(int iWhich) const {
+    size_t uiAt = GetItem(iWhich);
+    return (uiAt != JSON_TAPE_NONE && Json_TapeType(m_pTape, uiAt) == Json_NULL);
+}
+
+JsonTapeView::Iterator JsonTapeView::begin() const {
+    if (!IsArray() && !IsObject()) {
+        return (end());
+    }
+
+    return (Iterator(m_pTape, m_uiAt, Json_TapeChild(m_pTape, m_uiAt), m_bCaseSensitive));
+}
+
+JsonTapeView::Iterator JsonTapeView::end() const {
+    return (Iterator(m_pTape, m_uiAt, JSON_TAPE_NONE, m_bCaseSensitive));
+}
+
+std::string JsonTapeView::ToValueString() const {
+    Json oItem;
+    return (Load(m_uiAt, oItem) ? JsonView::ToValueString(&oItem) : std::string(""));
+}
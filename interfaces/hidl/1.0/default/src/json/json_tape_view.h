@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_TAPE_VIEW_H_
+#define JSON_TAPE_VIEW_H_
+
+#include <stddef.h>
+#include <string>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "json.h"
+#include "json_tape.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "json_object.h"
+
+class JsonTapeView;
+
+// A document parsed flat (json_tape.h): read-only, one block of entries and
+// one of strings instead of a node per value. For documents that are only
+// read: walking one is a front to back scan of memory. Move only.
+//
+//     JsonTape oConfig(strJson);
+//     oConfig.View()["cpuset"][0]("name");
+class JsonTape {
+public:
+    JsonTape() : m_pTape(NULL) {
+    }
+
+    explicit JsonTape(const std::string &strJson);
+
+    // a tape of the data of oJsonObject, which stays as it is
+    explicit JsonTape(const JsonObject &oJsonObject);
+
+    JsonTape(JsonTape &&oTape);
+
+    ~JsonTape();
+
+    JsonTape &operator=(JsonTape &&oTape);
+
+    bool Parse(const std::string &strJson);
+
+    void Clear();
+
+    bool IsEmpty() const {
+        return (m_pTape == NULL);
+    }
+
+    const std::string &GetErrMsg() const {
+        return (m_strErrMsg);
+    }
+
+    // valid as long as the tape is
+    JsonTapeView View(bool bCaseSensitive = false) const;
+
+    std::string ToString() const;
+
+    const Json_Tape *GetTape() const {
+        return (m_pTape);
+    }
+
+private:
+    JsonTape(const JsonTape &oTape);
+
+    JsonTape &operator=(const JsonTape &oTape);
+
+private:
+    Json_Tape *m_pTape;
+    std::string m_strErrMsg;
+};
+
+// JsonView on a tape: the same lookups, conversions and iteration, a value
+// known by its position instead of a node. A missing key, an index out of
+// range or a value of the wrong type gives an empty view, and every Get on
+// an empty view fails. Nothing is allocated but the std::string results.
+class JsonTapeView {
+public:
+    class Iterator;
+
+    JsonTapeView() : m_pTape(NULL), m_uiAt(JSON_TAPE_NONE), m_bCaseSensitive(false) {
+    }
+
+    JsonTapeView(const Json_Tape *pTape, size_t uiAt, bool bCaseSensitive = false)
+            : m_pTape(pTape), m_uiAt(pTape != NULL ? uiAt : JSON_TAPE_NONE), m_bCaseSensitive(bCaseSensitive) {
+    }
+
+    bool IsEmpty() const {
+        return (m_uiAt == JSON_TAPE_NONE);
+    }
+
+    bool IsArray() const {
+        return (!IsEmpty() && Json_TapeType(m_pTape, m_uiAt) == Json_Array);
+    }
+
+    bool IsObject() const {
+        return (!IsEmpty() && Json_TapeType(m_pTape, m_uiAt) == Json_Object);
+    }
+
+    // position on the tape, JSON_TAPE_NONE when empty
+    size_t GetPosition() const {
+        return (m_uiAt);
+    }
+
+    std::string ToString() const;
+
+public:     // method of json object
+    JsonTapeView operator[](const char *szKey) const;
+
+    JsonTapeView operator[](const std::string &strKey) const {
+        return (operator[](strKey.c_str()));
+    }
+
+    std::string operator()(const char *szKey) const;
+
+    std::string operator()(const std::string &strKey) const {
+        return (operator()(strKey.c_str()));
+    }
+
+    bool Get(const char *szKey, JsonTapeView &oJsonView) const;
+
+    bool Get(const char *szKey, std::string &strValue) const;
+
+    bool Get(const char *szKey, int32 &iValue) const;
+
+    bool Get(const char *szKey, uint32 &uiValue) const;
+
+    bool Get(const char *szKey, int64 &llValue) const;
+
+    bool Get(const char *szKey, uint64 &ullValue) const;
+
+    bool Get(const char *szKey, bool &bValue) const;
+
+    bool Get(const char *szKey, float &fValue) const;
+
+    bool Get(const char *szKey, double &dValue) const;
+
+    bool IsNull(const char *szKey) const;
+
+public:     // method of json array
+    int GetArraySize() const;
+
+    JsonTapeView operator[](int iWhich) const;
+
+    std::string operator()(int iWhich) const;
+
+    bool Get(int iWhich, JsonTapeView &oJsonView) const;
+
+    bool Get(int iWhich, std::string &strValue) const;
+
+    bool Get(int iWhich, int32 &iValue) const;
+
+    bool Get(int iWhich, uint32 &uiValue) const;
+
+    bool Get(int iWhich, int64 &llValue) const;
+
+    bool Get(int iWhich, uint64 &ullValue) const;
+
+    bool Get(int iWhich, bool &bValue) const;
+
+    bool Get(int iWhich, float &fValue) const;
+
+    bool Get(int iWhich, double &dValue) const;
+
+    bool IsNull(int iWhich) const;
+
+public:     // forward iteration over the items of a json array (the values of a json object)
+    Iterator begin() const;
+
+    Iterator end() const;
+
+public:     // conversion of this value, false when it has another type (JsonView::ToValue)
+    template<typename T>
+    bool ToValue(T &value) const;
+
+    std::string ToValueString() const;
+
+private:
+    size_t GetItem(const char *szKey) const;
+
+    size_t GetItem(int iWhich) const;
+
+    // the scalar at uiAt as a node that only links into the tape, false when there is none
+    bool Load(size_t uiAt, Json &oItem) const;
+
+private:
+    const Json_Tape *m_pTape;
+    size_t m_uiAt;
+    bool m_bCaseSensitive;
+};
+
+class JsonTapeView::Iterator {
+public:
+    Iterator(const Json_Tape *pTape, size_t uiParent, size_t uiAt, bool bCaseSensitive)
+            : m_pTape(pTape), m_uiParent(uiParent), m_uiAt(uiAt), m_bCaseSensitive(bCaseSensitive) {
+    }
+
+    JsonTapeView operator*() const {
+        return (JsonTapeView(m_pTape, m_uiAt, m_bCaseSensitive));
+    }
+
+    Iterator &operator++() {
+        m_uiAt = Json_TapeNext(m_pTape, m_uiParent, m_uiAt);
+        return (*this);
+    }
+
+    bool operator==(const Iterator &oIter) const {
+        return (m_uiAt == oIter.m_uiAt);
+    }
+
+    bool operator!=(const Iterator &oIter) const {
+        return (m_uiAt != oIter.m_uiAt);
+    }
+
+    // key of the current value when iterating a json object, NULL for array items
+    const char *GetKey() const {
+        return (Json_TapeType(m_pTape, m_uiParent) == Json_Object ? Json_TapeKey(m_pTape, m_uiAt) : NULL);
+    }
+
+private:
+    const Json_Tape *m_pTape;
+    size_t m_uiParent;
+    size_t m_uiAt;
+    bool m_bCaseSensitive;
+};
+
+template<typename T>
+bool JsonTapeView::ToValue(T &value) const {
+    Json oItem;
+    return (Load(m_uiAt, oItem) && JsonView::ToValue(&oItem, value));
+}
+
+#endif /* JSON_TAPE_VIEW_H_ */
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "json_view.h"
+
+std::string JsonView::ToString() const {
+    std::string strJsonData = "";
+    if (m_pJsonData == NULL) {
+        return (strJsonData);
+    }
+
+    char *pJsonString = Json_PrintUnformatted(m_pJsonData);
+    if (pJsonString != NULL) {
+        strJsonData = pJsonString;
+        free(pJsonString);
+    }
+
+    return (strJsonData);
+}
+
+Json *JsonView::GetItem(const char *szKey) const {
+    if (m_pJsonData == NULL || m_pJsonData->type != Json_Object) {
+        return (NULL);
+    }
+
+    if (m_bCaseSensitive) {
+        return (Json_GetObjectItemCaseSensitive(m_pJsonData, szKey));
+    }
+
+    return (Json_GetObjectItem(m_pJsonData, szKey));
+}
+
+Json *JsonView::GetItem(int iWhich) const {
+    if (m_pJsonData == NULL || m_pJsonData->type != Json_Array || iWhich < 0) {
+        return (NULL);
+    }
+
+    return (Json_GetArrayItem(m_pJsonData, iWhich));
+}
+
+JsonView JsonView::operator[](const char *szKey) const {
+    return (JsonView(GetItem(szKey), m_bCaseSensitive));
+}
+
+std::string JsonView::operator()(const char *szKey) const {
+    return (ToValueString(GetItem(szKey)));
+}
+
+bool JsonView::Get(const char *szKey, JsonView &oJsonView) const {
+    Json *pJsonStruct = GetItem(szKey);
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    oJsonView = JsonView(pJsonStruct, m_bCaseSensitive);
+    return (true);
+}
+
+bool JsonView::Get(const char *szKey, std::string &strValue) const {
+    return (ToValue(GetItem(szKey), strValue));
+}
+
+bool JsonView::Get(const char *szKey, int32 &iValue) const {
+    return (ToValue(GetItem(szKey), iValue));
+}
+
+bool JsonView::Get(const char *szKey, uint32 &uiValue) const {
+    return (ToValue(GetItem(szKey), uiValue));
+}
+
+bool JsonView::Get(const char *szKey, int64 &llValue) const {
+    return (ToValue(GetItem(szKey), llValue));
+}
+
+bool JsonView::Get(const char *szKey, uint64 &ullValue) const {
+    return (ToValue(GetItem(szKey), ullValue));
+}
+
+bool JsonView::Get(const char *szKey, bool &bValue) const {
+    return (ToValue(GetItem(szKey), bValue));
+}
+
+bool JsonView::Get(const char *szKey, float &fValue) const {
+    return (ToValue(GetItem(szKey), fValue));
+}
+
+bool JsonView::Get(const char *szKey, double &dValue) const {
+    return (ToValue(GetItem(szKey), dValue));
+}
+
+bool JsonView::IsNull(const char *szKey) const {
+    Json *pJsonStruct = GetItem(szKey);
+    return (pJsonStruct != NULL && pJsonStruct->type == Json_NULL);
+}
+
+int JsonView::GetArraySize() const {
+    if (m_pJsonData == NULL || m_pJsonData->type != Json_Array) {
+        return (0);
+    }
+
+    return (Json_GetArraySize(m_pJsonData));
+}
+
+JsonView JsonView::operator[](int iWhich) const {
+    return (JsonView(GetItem(iWhich), m_bCaseSensitive));
+}
+
+std::string JsonView::operator()(int iWhich) const {
+    return (ToValueString(GetItem(iWhich)));
+}
+
+bool JsonView::Get(int iWhich, JsonView &oJsonView) const {
+    Json *pJsonStruct = GetItem(iWhich);
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    oJsonView = JsonView(pJsonStruct, m_bCaseSensitive);
+    return (true);
+}
+
+bool JsonView::Get(int iWhich, std::string &strValue) const {
+    return (ToValue(GetItem(iWhich), strValue));
+}
+
+bool JsonView::Get(int iWhich, int32 &iValue) const {
+    return (ToValue(GetItem(iWhich), iValue));
+}
+
+bool JsonView::Get(int iWhich, uint32 &uiValue) const {
+    return (ToValue(GetItem(iWhich), uiValue));
+}
+
+bool JsonView::Get(int iWhich, int64 &llValue) const {
+    return (ToValue(GetItem(iWhich), llValue));
+}
+
+bool JsonView::Get(int iWhich, uint64 &ullValue) const {
+    return (ToValue(GetItem(iWhich), ullValue));
+}
+
+bool JsonView::Get(int iWhich, bool &bValue) const {
+    return (ToValue(GetItem(iWhich), bValue));
+}
+
+bool JsonView::Get(int iWhich, float &fValue) const {
+    return (ToValue(GetItem(iWhich), fValue));
+}
+
+bool JsonView::Get(int iWhich, double &dValue) const {
+    return (ToValue(GetItem(iWhich), dValue));
+}
+
+bool JsonView::IsNull(int iWhich) const {
+    Json *pJsonStruct = GetItem(iWhich);
+    return (pJsonStruct != NULL && pJsonStruct->type == Json_NULL);
+}
+
+JsonView::Iterator JsonView::begin() const {
+    if (m_pJsonData == NULL || (m_pJsonData->type != Json_Array && m_pJsonData->type != Json_Object)) {
+        return (Iterator(NULL, m_bCaseSensitive));
+    }
+
+    return (Iterator(m_pJsonData->child, m_bCaseSensitive));
+}
+
+JsonView::Iterator JsonView::end() const {
+    return (Iterator(NULL, m_bCaseSensitive));
+}
+
+JsonView::MemberRange JsonView::Members() const {
+    return (MemberRange(IsObject() ? m_pJsonData->child : NULL, m_bCaseSensitive));
+}
+
+std::string JsonView::ToValueString(const Json *pJsonStruct) {
+    char szNumber[128] = {0};
+    if (pJsonStruct == NULL) {
+        return (std::string(""));
+    }
+
+    switch (pJsonStruct->type) {
+        case Json_String:
+            return (pJsonStruct->valuestring);
+
+        case Json_Int:
+            if (pJsonStruct->sign == -1) {
+                snprintf(szNumber, sizeof(szNumber), "%lld", (int64) pJsonStruct->valueint);
+            } else {
+                snprintf(szNumber, sizeof(szNumber), "%llu", pJsonStruct->valueint);
+            }
+            return (std::string(szNumber));
+
+        case Json_Double:
+            if (fabs(pJsonStruct->valuedouble) < 1.0e-6 || fabs(pJsonStruct->valuedouble) > 1.0e9) {
+                snprintf(szNumber, sizeof(szNumber), "%e", pJsonStruct->valuedouble);
+            } else {
+                snprintf(szNumber, sizeof(szNumber), "%f", pJsonStruct->valuedouble);
+            }
+            return (std::string(szNumber));
+
+        case Json_False:
+            return (std::string("false"));
+
+        case Json_True:
+            return (std::string("true"));
+    }
+
+    return (std::string(""));
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, std::string &strValue) {
+    if (pJsonStruct == NULL || pJsonStruct->type != Json_String) {
+        return (false);
+    }
+
+    strValue = pJsonStruct->valuestring;
+    return (true);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, int32 &iValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Int) {
+        iValue = (int32) (pJsonStruct->valueint);
+        return (true);
+    } else if (pJsonStruct->type == Json_Double) {
+        iValue = (int32) (pJsonStruct->valuedouble);
+        return (true);
+    }
+
+    return (false);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, uint32 &uiValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Int) {
+        uiValue = (uint32) (pJsonStruct->valueint);
+        return (true);
+    } else if (pJsonStruct->type == Json_Double) {
+        uiValue = (uint32) (pJsonStruct->valuedouble);
+        return (true);
+    }
+
+    return (false);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, int64 &llValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Int) {
+        llValue = (int64) (pJsonStruct->valueint);
+        return (true);
+    } else if (pJsonStruct->type == Json_Double) {
+        llValue = (int64) (pJsonStruct->valuedouble);
+        return (true);
+    }
+
+    return (false);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, uint64 &ullValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Int) {
+        ullValue = (uint64) (pJsonStruct->valueint);
+        return (true);
+    } else if (pJsonStruct->type == Json_Double) {
+        ullValue = (uint64) (pJsonStruct->valuedouble);
+        return (true);
+    }
+
+    return (false);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, bool &bValue) {
+    if (pJsonStruct == NULL || pJsonStruct->type > Json_True) {
+        return (false);
+    }
+
+    bValue = pJsonStruct->type;
+    return (true);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, float &fValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Double) {
+        fValue = (float) (pJsonStruct->valuedouble);
+        return (true);
+    } else if (pJsonStruct->type == Json_Int) {
+        fValue = (float) (pJsonStruct->valueint);
+        return (true);
+    }
+
+    return (false);
+}
+
+bool JsonView::ToValue(const Json *pJsonStruct, double &dValue) {
+    if (pJsonStruct == NULL) {
+        return (false);
+    }
+
+    if (pJsonStruct->type == Json_Double) {
+        dValue = (double) (pJsonStruct->valuedouble);
+        return (true);
+    } else if (pJsonStruct->type == Json_Int) {
+        dValue = (double) (pJsonStruct->valueint);
+        return (true);
+    }
+
+    return (false);
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_VIEW_H_
+#define JSON_VIEW_H_
+
+#include <stddef.h>
+#include <string>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "json.h"
+#include "json_path.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+// A read-only handle on one node of a parsed tree: copying it copies a pointer,
+// indexing it allocates nothing and caches nothing. A missing key, an index out
+// of range or a node of the wrong type gives an empty view, and every Get on an
+// empty view fails, so lookups can be chained without checks in between.
+// It must not outlive the tree it was taken from (JsonObject::View()).
+class JsonView {
+public:
+    class Iterator;
+
+    JsonView() : m_pJsonData(NULL), m_bCaseSensitive(false) {
+    }
+
+    explicit JsonView(Json *pJsonData, bool bCaseSensitive = false)
+            : m_pJsonData(pJsonData), m_bCaseSensitive(bCaseSensitive) {
+    }
+
+    bool IsEmpty() const {
+        return (m_pJsonData == NULL);
+    }
+
+    bool IsArray() const {
+        return (m_pJsonData != NULL && m_pJsonData->type == Json_Array);
+    }
+
+    bool IsObject() const {
+        return (m_pJsonData != NULL && m_pJsonData->type == Json_Object);
+    }
+
+    Json *GetJson() const {
+        return (m_pJsonData);
+    }
+
+    std::string ToString() const;
+
+public:     // method of json object
+    JsonView operator[](const char *szKey) const;
+
+    JsonView operator[](const std::string &strKey) const {
+        return (operator[](strKey.c_str()));
+    }
+
+    std::string operator()(const char *szKey) const;
+
+    std::string operator()(const std::string &strKey) const {
+        return (operator()(strKey.c_str()));
+    }
+
+    bool Get(const char *szKey, JsonView &oJsonView) const;
+
+    bool Get(const char *szKey, std::string &strValue) const;
+
+    bool Get(const char *szKey, int32 &iValue) const;
+
+    bool Get(const char *szKey, uint32 &uiValue) const;
+
+    bool Get(const char *szKey, int64 &llValue) const;
+
+    bool Get(const char *szKey, uint64 &ullValue) const;
+
+    bool Get(const char *szKey, bool &bValue) const;
+
+    bool Get(const char *szKey, float &fValue) const;
+
+    bool Get(const char *szKey, double &dValue) const;
+
+    bool IsNull(const char *szKey) const;
+
+    // the first match of a compiled pointer (json_path.h) under this node;
+    // the path decides case sensitivity, the result keeps this view's
+    JsonView At(const Json_Path *pPath) const {
+        return (JsonView(m_pJsonData != NULL ? Json_PathFind(pPath, m_pJsonData) : NULL, m_bCaseSensitive));
+    }
+
+public:     // method of json array
+    int GetArraySize() const;
+
+    JsonView operator[](int iWhich) const;
+
+    std::string operator()(int iWhich) const;
+
+    bool Get(int iWhich, JsonView &oJsonView) const;
+
+    bool Get(int iWhich, std::string &strValue) const;
+
+    bool Get(int iWhich, int32 &iValue) const;
+
+    bool Get(int iWhich, uint32 &uiValue) const;
+
+    bool Get(int iWhich, int64 &llValue) const;
+
+    bool Get(int iWhich, uint64 &ullValue) const;
+
+    bool Get(int iWhich, bool &bValue) const;
+
+    bool Get(int iWhich, float &fValue) const;
+
+    bool Get(int iWhich, double &dValue) const;
+
+    bool IsNull(int iWhich) const;
+
+public:     // forward iteration over the items of a json array (the values of a json object)
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    // fn(JsonView oItem) for each item of a json array in order, nothing copied;
+    // returns the number of items, 0 when this is not an array
+    template<typename Fn>
+    int ForEach(Fn fn) const {
+        int iCount = 0;
+        if (!IsArray()) {
+            return (0);
+        }
+
+        for (Json *pItem = m_pJsonData->child; pItem != NULL; pItem = pItem->next, ++iCount) {
+            fn(JsonView(pItem, m_bCaseSensitive));
+        }
+
+        return (iCount);
+    }
+
+public:     // the members of a json object, key and value together, straight off the tree:
+    // for (const JsonView::Member &oMember : oView.Members()) { oMember.szKey; oMember.oValue; }
+    struct Member;
+
+    class MemberIterator;
+
+    class MemberRange;
+
+    MemberRange Members() const;
+
+public:     // conversion of a single node, false when it has another type
+    static std::string ToValueString(const Json *pJsonStruct);
+
+    static bool ToValue(const Json *pJsonStruct, std::string &strValue);
+
+    static bool ToValue(const Json *pJsonStruct, int32 &iValue);
+
+    static bool ToValue(const Json *pJsonStruct, uint32 &uiValue);
+
+    static bool ToValue(const Json *pJsonStruct, int64 &llValue);
+
+    static bool ToValue(const Json *pJsonStruct, uint64 &ullValue);
+
+    static bool ToValue(const Json *pJsonStruct, bool &bValue);
+
+    static bool ToValue(const Json *pJsonStruct, float &fValue);
+
+    static bool ToValue(const Json *pJsonStruct, double &dValue);
+
+private:
+    Json *GetItem(const char *szKey) const;
+
+    Json *GetItem(int iWhich) const;
+
+private:
+    Json *m_pJsonData;
+    bool m_bCaseSensitive;
+};
+
+// a member of a json object: its key, and a view of its value
+struct JsonView::Member {
+    const char *szKey;
+    JsonView oValue;
+};
+
+class JsonView::Iterator {
+public:
+    Iterator(Json *pNode, bool bCaseSensitive) : m_pNode(pNode), m_bCaseSensitive(bCaseSensitive) {
+    }
+
+    JsonView operator*() const {
+        return (JsonView(m_pNode, m_bCaseSensitive));
+    }
+
+    Iterator &operator++() {
+        m_pNode = m_pNode->next;
+        return (*this);
+    }
+
+    bool operator==(const Iterator &oIter) const {
+        return (m_pNode == oIter.m_pNode);
+    }
+
+    bool operator!=(const Iterator &oIter) const {
+        return (m_pNode != oIter.m_pNode);
+    }
+
+    // key of the current value when iterating a json object, NULL for array items
+    const char *GetKey() const {
+        return (m_pNode->string);
+    }
+
+private:
+    Json *m_pNode;
+    bool m_bCaseSensitive;
+};
+
+class JsonView::MemberIterator {
+public:
+    MemberIterator(Json *pNode, bool bCaseSensitive) : m_bCaseSensitive(bCaseSensitive) {
+        Seek(pNode);
+    }
+
+    const Member &operator*() const {
+        return (m_oMember);
+    }
+
+    const Member *operator->() const {
+        return (&m_oMember);
+    }
+
+    MemberIterator &operator++() {
+        Seek(m_pNode->next);
+        return (*this);
+    }
+
+    bool operator==(const MemberIterator &oIter) const {
+        return (m_pNode == oIter.m_pNode);
+    }
+
+    bool operator!=(const MemberIterator &oIter) const {
+        return (m_pNode != oIter.m_pNode);
+    }
+
+private:
+    void Seek(Json *pNode) {
+        m_pNode = pNode;
+        m_oMember.szKey = pNode != NULL ? pNode->string : NULL;
+        m_oMember.oValue = JsonView(pNode, m_bCaseSensitive);
+    }
+
+private:
+    Json *m_pNode;
+    Member m_oMember;
+    bool m_bCaseSensitive;
+};
+
+class JsonView::MemberRange {
+public:
+    MemberRange(Json *pFirst, bool bCaseSensitive) : m_pFirst(pFirst), m_bCaseSensitive(bCaseSensitive) {
+    }
+
+    MemberIterator begin() const {
+        return (MemberIterator(m_pFirst, m_bCaseSensitive));
+    }
+
+    MemberIterator end() const {
+        return (MemberIterator(NULL, m_bCaseSensitive));
+    }
+
+private:
+    Json *m_pFirst;
+    bool m_bCaseSensitive;
+};
+
+#endif /* JSON_VIEW_H_ */
@@ -15,10 +15,18 @@
  */
 
 
+#include <fcntl.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
 #include "cpu_policy_agent.h"
 #include "../log.h"
-#include "../utils.h"
-#include "../json/json_object.h"
+
+extern "C" {
+#include "../json/json_reader.h"
+}
+
 #include "../factors.h"
 
 #define LOG_TAG        "J007Engine-CpuPolicyAgent"
@@ -32,12 +40,13 @@ CpuPolicyAgent::CpuPolicyAgent() {
 CpuPolicyAgent::~CpuPolicyAgent() {
 }
 
-bool CpuPolicyAgent::onAppSwitch(App app, string status, string packageName) {
+bool CpuPolicyAgent::onAppSwitch(const App &app, const string &status, const string &packageName) {
     LOGI("app switch, packageName = %s , type = %s , status = %s\n", app.packageName.c_str(), app.type.c_str(),
          status.c_str());
 
     string cup_set = mAppType[app.type];
     LOGI("cup_set = %s \n", cup_set.c_str());
+    mPolicy = cup_set;
     map <string, string> configs = mCpuConfig[cup_set];
     for (auto &&config : configs) {
         LOGI("cpu = %s , value = %s\n", config.first.c_str(), config.second.c_str());
@@ -48,28 +57,126 @@ bool CpuPolicyAgent::onAppSwitch(App app, string status, string packageName) {
     return true;
 }
 
-bool CpuPolicyAgent::loadConfig() {
-    string configs = Utils::readFile(CPU_POLICY_AGENT_FILE);
-    JsonObject oJson(configs);
-    LOGD("cpuset size = %d ", oJson["cpuset"].GetArraySize());
-    for (int i = 0; i < oJson["cpuset"].GetArraySize(); ++i) {
-        string name;
-        map <string, string> config;
-
-        oJson["cpuset"][i].Get("name", name);
-        LOGD("name = %s, configs = %d ", name.c_str(), oJson["cpuset"][i]["config"].GetArraySize());
-        for (int j = 0; j < oJson["cpuset"][i]["config"].GetArraySize(); ++j) {
-            string cpu = oJson["cpuset"][i]["config"][j]("cpu");
-            string value = oJson["cpuset"][i]["config"][j]("value");
-            //LOGD("cpu = %s , value = %s\n", cpu.c_str(), value.c_str());
-            config.insert({cpu, value});
+//the cpuset follows the app type alone: another app of the same type keeps it
+uint32_t CpuPolicyAgent::getSceneFields() {
+    return SCENE_FIELD_APP_TYPE;
+}
+
+string CpuPolicyAgent::getPolicy() {
+    return mPolicy;
+}
+
+// "key": "string", anything else leaves value untouched
+static bool readString(Json_Reader *pReader, string &value) {
+    if (Json_ReaderNext(pReader) != Json_EventValue) {
+        return false;
+    }
+
+    const Json *pItem = Json_ReaderItem(pReader);
+    if (pItem->type == Json_String) {
+        value = pItem->valuestring;
+    }
+    return true;
+}
+
+// {"cpu": "...", "value": "..."}
+static bool readCpuConfig(Json_Reader *pReader, map <string, string> &config) {
+    string cpu, value;
+    int event;
+
+    while ((event = Json_ReaderNext(pReader)) == Json_EventKey) {
+        const char *key = Json_ReaderItem(pReader)->valuestring;
+        if (!strcasecmp(key, "cpu")) {
+            if (!readString(pReader, cpu)) return false;
+        } else if (!strcasecmp(key, "value")) {
+            if (!readString(pReader, value)) return false;
+        } else if (Json_ReaderSkip(pReader) <= 0) {
+            return false;
         }
-        mCpuConfig.insert({name, config});
+    }
+    if (event != Json_EventEndObject) {
+        return false;
     }
 
+    //LOGD("cpu = %s , value = %s\n", cpu.c_str(), value.c_str());
+    config.insert({cpu, value});
     return true;
 }
 
+// {"name": "...", "config": [{...}, ...]}
+static bool readCpuset(Json_Reader *pReader, map <string, map<string, string>> &cpuConfig) {
+    string name;
+    map <string, string> config;
+    int event;
+
+    while ((event = Json_ReaderNext(pReader)) == Json_EventKey) {
+        const char *key = Json_ReaderItem(pReader)->valuestring;
+        if (!strcasecmp(key, "name")) {
+            if (!readString(pReader, name)) return false;
+        } else if (!strcasecmp(key, "config")) {
+            if (Json_ReaderNext(pReader) != Json_EventStartArray) return false;
+            while ((event = Json_ReaderNext(pReader)) == Json_EventStartObject) {
+                if (!readCpuConfig(pReader, config)) return false;
+            }
+            if (event != Json_EventEndArray) return false;
+        } else if (Json_ReaderSkip(pReader) <= 0) {
+            return false;
+        }
+    }
+    if (event != Json_EventEndObject) {
+        return false;
+    }
+
+    LOGD("name = %s, configs = %zu ", name.c_str(), config.size());
+    cpuConfig.insert({name, config});
+    return true;
+}
+
+// Streams the file through a Json_Reader straight into mCpuConfig, no tree is built
+// and only the reader's buffer is held in memory however large the file grows.
+bool CpuPolicyAgent::loadConfig() {
+    int fd = TEMP_FAILURE_RETRY(open(CPU_POLICY_AGENT_FILE, O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+        LOGE("open file %s failed.", CPU_POLICY_AGENT_FILE);
+        return false;
+    }
+
+    Json_Reader *pReader = Json_ReaderCreate(0);
+    if (pReader == NULL) {
+        close(fd);
+        return false;
+    }
+
+    Json_ReaderSetFd(pReader, fd);
+    bool ret = (Json_ReaderNext(pReader) == Json_EventStartObject);
+    int event = Json_EventEnd;
+    while (ret && (event = Json_ReaderNext(pReader)) == Json_EventKey) {
+        if (strcasecmp(Json_ReaderItem(pReader)->valuestring, "cpuset")) {
+            ret = (Json_ReaderSkip(pReader) > 0);
+            continue;
+        }
+
+        ret = (Json_ReaderNext(pReader) == Json_EventStartArray);
+        while (ret && (event = Json_ReaderNext(pReader)) == Json_EventStartObject) {
+            ret = readCpuset(pReader, mCpuConfig);
+        }
+        ret = ret && (event == Json_EventEndArray);
+    }
+    ret = ret && (event == Json_EventEndObject);
+
+    if (!ret) {
+        size_t offset = 0;
+        const char *error = Json_ReaderGetError(pReader, &offset);
+        LOGE("load %s failed at %zu: %s", CPU_POLICY_AGENT_FILE, offset,
+             error ? error : "unexpected structure");
+    }
+    LOGD("cpuset size = %zu ", mCpuConfig.size());
+
+    Json_ReaderDestroy(pReader);
+    close(fd);
+    return ret;
+}
+
 void CpuPolicyAgent::initMap() {
     mAppType.insert({APP_DEFAULT, CPU_SET_APP_DEFAULT});
 
@@ -41,7 +41,11 @@ public:
 
     virtual ~CpuPolicyAgent();
 
-    bool onAppSwitch(App app, string status, string packageName) override;
+    bool onAppSwitch(const App &app, const string &status, const string &packageName) override;
+
+    uint32_t getSceneFields() override;
+
+    string getPolicy() override;
 
 protected:
     bool loadConfig() override;
@@ -51,6 +55,9 @@ private:
 
     map <string, map<string, string>> mCpuConfig;
     map <string, string> mAppType;
+
+    //cpuset applied last
+    string mPolicy;
 };
 
 
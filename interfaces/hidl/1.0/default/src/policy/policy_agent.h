@@ -32,10 +32,20 @@ public:
 
     virtual ~PolicyAgent();
 
-    virtual bool onAppSwitch(App app, string status, string packageName) {
+    virtual bool onAppSwitch(const App &app, const string &status, const string &packageName) {
         return true;
     }
 
+    //SCENE_FIELD_* the agent acts on: it hears of a scene only when one of them changed
+    virtual uint32_t getSceneFields() {
+        return SCENE_FIELDS_ALL;
+    }
+
+    //name of the policy applied last, for the scene history
+    virtual string getPolicy() {
+        return "";
+    }
+
 protected:
     virtual bool loadConfig() {
         return true;
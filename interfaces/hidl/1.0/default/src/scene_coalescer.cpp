@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scene_coalescer.h"
+#include "factors.h"
+
+SceneCoalescer::SceneCoalescer(Apply apply, int windowMs)
+        : mApply(apply), mWindow(chrono::milliseconds(windowMs > 0 ? windowMs : 0)), mStop(false),
+          mPendingCount(0), mPendingChanged(0), mDue(), mAppQuiet(), mStats(),
+          mThread(&SceneCoalescer::loop, this) {
+}
+
+SceneCoalescer::~SceneCoalescer() {
+    {
+        lock_guard<mutex> lock(mLock);
+        mStop = true;
+    }
+    mWakeup.notify_one();
+    mThread.join();
+}
+
+void SceneCoalescer::setWindow(int windowMs) {
+    lock_guard<mutex> lock(mLock);
+    mWindow = chrono::milliseconds(windowMs > 0 ? windowMs : 0);
+    //what is pending waits no longer than the new window
+    if (mPendingCount != 0 && mDue > Clock::now() + mWindow) {
+        mDue = Clock::now() + mWindow;
+        mWakeup.notify_one();
+    }
+}
+
+int SceneCoalescer::getWindow() {
+    lock_guard<mutex> lock(mLock);
+    return (int) chrono::duration_cast<chrono::milliseconds>(mWindow).count();
+}
+
+void SceneCoalescer::post(int32_t factors, uint32_t changed) {
+    unique_lock<mutex> lock(mLock);
+    Clock::time_point now = Clock::now();
+    bool pending = mPendingCount != 0;
+
+    mStats.received++;
+    mPendingCount++;
+    mPendingChanged |= changed;
+
+    if (mWindow == Clock::duration::zero()) {
+        flush(lock);
+        return;
+    }
+
+    if (factors == SCENE_FACTOR_APP) {
+        //the first switch in a while is what the user waits on, it goes through with anything pending
+        if (now >= mAppQuiet) {
+            mAppQuiet = now + mWindow;
+            flush(lock);
+            return;
+        }
+
+        //one came just before: this one, or a later one, when the window closes
+        mDue = pending && mDue < mAppQuiet ? mDue : mAppQuiet;
+    } else if (!pending) {
+        mDue = now + mWindow;
+    }
+    mWakeup.notify_one();
+}
+
+void SceneCoalescer::getStats(Stats &stats) {
+    lock_guard<mutex> lock(mLock);
+    stats = mStats;
+}
+
+void SceneCoalescer::flush(unique_lock<mutex> &lock) {
+    uint32_t count = mPendingCount, changed = mPendingChanged;
+    if (count == 0) {
+        return;
+    }
+
+    mPendingCount = 0;
+    mPendingChanged = 0;
+    mStats.applied++;
+    mStats.merged += count - 1;
+
+    lock.unlock();
+    {
+        lock_guard<mutex> apply(mApplyLock);
+        mApply(changed);
+    }
+    lock.lock();
+}
+
+void SceneCoalescer::loop() {
+    unique_lock<mutex> lock(mLock);
+    while (!mStop) {
+        if (mPendingCount == 0) {
+            mWakeup.wait(lock);
+        } else if (Clock::now() < mDue) {
+            mWakeup.wait_until(lock, mDue);
+        } else {
+            flush(lock);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SCENE_COALESCER_H
+#define _SCENE_COALESCER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+//stands between the published scenes and the agents: updates that come within a window of each
+//other are applied once, for the scene current by then, with the fields all of them changed.
+//Later updates of a factor win: the scene applied already holds them.
+//An app switch is applied at once, unless another one was in the window before it: a burst of
+//switches costs the first one and the last one
+class SceneCoalescer {
+public:
+    //applies the scene current now, changed: the SCENE_FIELD_* of every update since the last call.
+    //Never called twice at the same time
+    typedef function<void(uint32_t changed)> Apply;
+
+    struct Stats {
+        //updates posted
+        uint64_t received;
+        //updates applied with others instead of on their own
+        uint64_t merged;
+        //calls to apply
+        uint64_t applied;
+    };
+
+    //window 0: every update is applied at once, on the thread posting it
+    SceneCoalescer(Apply apply, int windowMs);
+
+    ~SceneCoalescer();
+
+    void setWindow(int windowMs);
+
+    int getWindow();
+
+    //an update has published a scene: factors, and the fields it changed
+    void post(int32_t factors, uint32_t changed);
+
+    void getStats(Stats &stats);
+
+private:
+    SceneCoalescer(const SceneCoalescer &coalescer);
+
+    SceneCoalescer &operator=(const SceneCoalescer &coalescer);
+
+    typedef chrono::steady_clock Clock;
+
+    //applies the updates pending, called with lock held: unlocks it meanwhile
+    void flush(unique_lock<mutex> &lock);
+
+    void loop();
+
+    Apply mApply;
+    Clock::duration mWindow;
+
+    mutex mLock;
+    condition_variable mWakeup;
+    bool mStop;
+
+    //updates posted and not applied yet, the fields they changed, and when they are due
+    uint32_t mPendingCount;
+    uint32_t mPendingChanged;
+    Clock::time_point mDue;
+
+    //until when an app switch waits for the window to close
+    Clock::time_point mAppQuiet;
+
+    Stats mStats;
+
+    //keeps the calls to mApply one at a time
+    mutex mApplyLock;
+
+    thread mThread;
+};
+
+
+#endif //_SCENE_COALESCER_H
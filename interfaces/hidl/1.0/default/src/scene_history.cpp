@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "scene_history.h"
+
+//as much of src as fits dst, always 0 terminated
+static void copyText(char *dst, size_t size, const char *src, size_t len) {
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = 0;
+}
+
+SceneHistory::SceneHistory() : mCount(0) {
+    memset(mEntries, 0, sizeof(mEntries));
+}
+
+SceneHistory::~SceneHistory() {
+}
+
+void SceneHistory::record(const Scene &scene) {
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+
+    lock_guard<mutex> lock(mLock);
+    Entry &entry = mEntries[mCount % CAPACITY];
+    entry.timestamp = (int64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+    entry.version = scene.version;
+    entry.factors = scene.source.factors;
+    copyText(entry.packageName, sizeof(entry.packageName), scene.source.packageName.data(),
+             scene.source.packageName.size());
+    copyText(entry.appType, sizeof(entry.appType), scene.app.type.data(), scene.app.type.size());
+    entry.policy[0] = 0;
+    entry.applied = false;
+    mCount++;
+}
+
+void SceneHistory::recordPolicy(uint64_t version, const char *policy) {
+    lock_guard<mutex> lock(mLock);
+    size_t count = mCount < CAPACITY ? (size_t) mCount : CAPACITY;
+
+    //updates racing each other may have recorded out of version order: look at every entry
+    for (uint64_t i = mCount - count; i < mCount; i++) {
+        Entry &entry = mEntries[i % CAPACITY];
+        if (!entry.applied && entry.version <= version) {
+            copyText(entry.policy, sizeof(entry.policy), policy != NULL ? policy : "",
+                     policy != NULL ? strlen(policy) : 0);
+            entry.applied = true;
+        }
+    }
+}
+
+void SceneHistory::getEntries(size_t maxEntries, vector<Entry> &entries) {
+    lock_guard<mutex> lock(mLock);
+    size_t count = mCount < CAPACITY ? (size_t) mCount : CAPACITY;
+    if (maxEntries != 0 && maxEntries < count) {
+        count = maxEntries;
+    }
+
+    entries.clear();
+    entries.reserve(count);
+    for (uint64_t i = mCount - count; i < mCount; i++) {
+        entries.push_back(mEntries[i % CAPACITY]);
+    }
+}
+
+uint64_t SceneHistory::getCount() {
+    lock_guard<mutex> lock(mLock);
+    return mCount;
+}
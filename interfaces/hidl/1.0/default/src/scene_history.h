@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SCENE_HISTORY_H
+#define _SCENE_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+#include "global_scene.h"
+
+using namespace std;
+
+//the last scene transitions, for finding out afterwards what the engine went through before
+//a jank or a power report. A fixed ring of fixed size entries: recording never allocates,
+//the oldest entry makes room for the newest
+class SceneHistory {
+public:
+    static const size_t CAPACITY = 256;
+
+    //longer texts are cut, still 0 terminated
+    static const size_t PACKAGE_NAME_SIZE = 96;
+    static const size_t APP_TYPE_SIZE = 16;
+    static const size_t POLICY_SIZE = 16;
+
+    struct Entry {
+        //CLOCK_BOOTTIME, in nanoseconds: keeps counting in suspend, as the reports do
+        int64_t timestamp;
+        //of the scene published by the transition
+        uint64_t version;
+        int32_t factors;
+        char packageName[PACKAGE_NAME_SIZE];
+        //app type of the scene, as decoded from its status
+        char appType[APP_TYPE_SIZE];
+        //what the agents applied for it, empty when none ran or until they have
+        char policy[POLICY_SIZE];
+        //whether the agents have run for it yet
+        bool applied;
+    };
+
+    SceneHistory();
+
+    ~SceneHistory();
+
+    //the transition to scene, from any thread, as it is published: the agents come later
+    void record(const Scene &scene);
+
+    //the agents have run for the scene of version: policy is what they applied, for it and for
+    //the transitions before it still waiting on them
+    void recordPolicy(uint64_t version, const char *policy);
+
+    //the last maxEntries transitions (all of them for 0), oldest first
+    void getEntries(size_t maxEntries, vector<Entry> &entries);
+
+    //transitions recorded so far, those the ring has dropped included
+    uint64_t getCount();
+
+private:
+    SceneHistory(const SceneHistory &history);
+
+    SceneHistory &operator=(const SceneHistory &history);
+
+    mutex mLock;
+    Entry mEntries[CAPACITY];
+    uint64_t mCount;
+};
+
+
+#endif //_SCENE_HISTORY_H
@@ -14,7 +14,7 @@
  * limitations under the License.
  */
 
-#include <com/journeyOS/J007engine/hidl/1.0/IJ007Engine.h>
+#include <com/journeyOS/J007engine/hidl/1.1/IJ007Engine.h>
 #include <hidl/LegacySupport.h>
 
 #include "log.h"
@@ -25,7 +25,7 @@ using android::hardware::configureRpcThreadpool;
 using android::hardware::joinRpcThreadpool;
 
 // Generated HIDL files
-using ::com::journeyOS::J007engine::hidl::V1_0::IJ007Engine;
+using ::com::journeyOS::J007engine::hidl::V1_1::IJ007Engine;
 
 using ::android::status_t;
 using ::android::OK;
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+
+#include "json/json_object.h"
+
+extern "C" {
+#include "json/json_arena.h"
+#include "json/json_atom.h"
+#include "json/json_binary.h"
+#include "json/json_reader.h"
+#include "json/json_tape.h"
+}
+
+using namespace std;
+
+// NaN and infinities print as null, they can't survive a round trip through text
+static bool isFinite(const Json *item) {
+    if ((item->type & 255) == Json_Double && !isfinite(item->valuedouble)) {
+        return false;
+    }
+
+    for (const Json *child = item->child; child != NULL; child = child->next) {
+        if (!isFinite(child)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// An integer's bits must say the same number its double does, sign included: a number too
+// negative for them is only a double
+static bool sameSign(const Json *item) {
+    if ((item->type & 255) == Json_Int
+        && (item->sign == -1 && (int64) item->valueint < 0) != (item->valuedouble < 0)) {
+        return false;
+    }
+
+    for (const Json *child = item->child; child != NULL; child = child->next) {
+        if (!sameSign(child)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Some keys interned, as GlobalScene has them: the parsers take these as atoms and copy the others
+extern "C" int LLVMFuzzerInitialize(int *, char ***) {
+    static const char *keys[] = {"app", "battery", "packageName", "type", "mode", "fps", "cpu", "Config"};
+    for (const char *key : keys) {
+        Json_Intern(key);
+    }
+
+    return 0;
+}
+
+// Every input goes through Json_Parse. The other ways into a tree must agree with it on what
+// parses and what it parses to, and what parses must read back the same once printed.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    // the text parsers want a terminated string
+    string text(reinterpret_cast<const char *>(data), size);
+
+    Json *doc = Json_Parse(text.c_str());
+
+    Json *descent = Json_ParseDescent(text.c_str());
+    if ((doc == NULL) != (descent == NULL) || !Json_Compare(doc, descent)) {
+        abort();
+    }
+    Json_Delete(descent);
+
+    string buffer(text);
+    Json *insitu = Json_ParseInSitu(&buffer[0]);
+    if ((doc == NULL) != (insitu == NULL) || !Json_Compare(doc, insitu)) {
+        abort();
+    }
+    Json_Delete(insitu);
+
+    Json_Arena *arena = Json_ArenaCreate(0);
+    Json *inArena = Json_ParseInArena(text.c_str(), arena);
+    if ((doc == NULL) != (inArena == NULL) || !Json_Compare(doc, inArena)) {
+        abort();
+    }
+    Json_Delete(inArena);
+    Json_ArenaDestroy(arena);
+
+    // members left out are only checked: that must accept and reject exactly what parsing does
+    static const char *const members[] = {"app", "battery"};
+    Json *lazy = Json_ParseMembers(text.c_str(), members, 2);
+    if ((lazy != NULL) != (doc != NULL && (doc->type & 255) == Json_Object)) {
+        abort();
+    }
+    Json_Delete(lazy);
+
+    if (doc != NULL) {
+        if (!sameSign(doc)) {
+            abort();
+        }
+
+        char *printed = Json_PrintUnformatted(doc);
+        Json *reparsed = Json_Parse(printed);
+        if (reparsed == NULL || (isFinite(doc) && !Json_Compare(doc, reparsed))) {
+            abort();
+        }
+        Json_Delete(reparsed);
+        free(printed);
+
+        Json *copy = Json_Duplicate(doc, 1);
+        if (!Json_Compare(doc, copy)) {
+            abort();
+        }
+        Json_Delete(copy);
+
+        Json_Tape *tape = Json_TapeFromTree(doc);
+        Json *flat = tape != NULL ? Json_TapeToTree(tape, 0) : NULL;
+        if (flat == NULL || !Json_Compare(doc, flat)) {
+            abort();
+        }
+        Json_Delete(flat);
+        Json_TapeDelete(tape);
+    }
+
+    // the streaming reader, the tape built on it and the binary decoder only must not misbehave
+    Json_Reader *reader = Json_ReaderCreate(0);
+    Json_ReaderSetText(reader, text.data(), text.size());
+    while (Json_ReaderNext(reader) > 0) {
+    }
+    Json_ReaderDestroy(reader);
+
+    Json_TapeDelete(Json_TapeParse(text.data(), text.size()));
+
+    Json_Delete(Json_ParseBinary(text.data(), text.size()));
+
+    JsonObject oJson;
+    if (oJson.Parse(text) != (doc != NULL)) {
+        abort();
+    }
+
+    Json_Delete(doc);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021 anqi.huang@outlook.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The same app and battery updates through the engine service both ways: json text through
+// notifySceneChanged (1.0), and the typed notifyAppSwitch / notifyBattery (1.1).
+// Leaves the engine with the benchmark's scene, run it on debug builds only.
+//
+//     scene_benchmark [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+
+#include <com/journeyOS/J007engine/hidl/1.1/IJ007Engine.h>
+
+using ::android::sp;
+using ::android::hardware::hidl_string;
+using ::android::hardware::Return;
+// Generated HIDL files
+using ::com::journeyOS::J007engine::hidl::V1_1::IJ007Engine;
+using ::com::journeyOS::J007engine::hidl::V1_1::AppScene;
+using ::com::journeyOS::J007engine::hidl::V1_1::BatteryScene;
+using namespace std;
+
+#define SCENE_FACTOR_APP                (1 << 1)
+#define SCENE_FACTOR_BATTERY            (1 << 6)
+
+// What NotifyManager sends for SCENE_FACTOR_APP / SCENE_FACTOR_BATTERY (gson, SceneState),
+// fps and level/temperature left open: the engine drops a status it got just before unparsed,
+// so the calls take turns with two scenes to make each one do the whole update
+static const char *SCENE_APP =
+        "{\"battery\":{\"level\":85,\"pluggedIn\":0,\"status\":3,\"health\":2,\"temperature\":312},"
+        "\"app\":{\"packageName\":\"com.tencent.mm\",\"type\":\"im\",\"mode\":-1,\"fps\":%d,\"cpu\":-1,"
+        "\"memc\":-1,\"bl\":0},\"brightness\":128}";
+
+static const char *SCENE_BATTERY =
+        "{\"battery\":{\"level\":%d,\"pluggedIn\":2,\"status\":2,\"health\":2,\"temperature\":%d},"
+        "\"brightness\":-1}";
+
+// the two scenes the calls take turns with
+static const int SCENE_FPS[2] = {60, 90};
+static const int SCENE_LEVEL[2] = {42, 43};
+static const int SCENE_TEMPERATURE[2] = {367, 368};
+
+// the arguments as hwbinder copies them: the flat arguments, then the buffer of every string
+// they hold, 0 included. The interface token and the buffer object headers come on top
+static size_t stringBytes(const hidl_string &str) {
+    return str.size() + 1;
+}
+
+static size_t sceneChangedBytes(const hidl_string &status, const hidl_string &packageName) {
+    return sizeof(int32_t) + 2 * sizeof(hidl_string) + stringBytes(status) + stringBytes(packageName);
+}
+
+static size_t appSwitchBytes(const AppScene &app) {
+    return sizeof(AppScene) + stringBytes(app.packageName) + stringBytes(app.type);
+}
+
+static size_t batteryBytes(const BatteryScene &) {
+    return sizeof(BatteryScene);
+}
+
+template<typename Fn>
+static void bench(const char *label, size_t bytes, int iterations, Fn fn) {
+    // warm up the binder threads and the engine
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        fn(i);
+    }
+
+    double best = 0, total = 0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = chrono::steady_clock::now();
+        if (!fn(i)) {
+            printf("%-24s call failed\n", label);
+            return;
+        }
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        best = (i == 0 || ns < best) ? ns : best;
+        total += ns;
+    }
+
+    printf("%-24s %6zu bytes %10.1f us/call (mean) %10.1f us/call (best)\n", label, bytes,
+           total / iterations / 1000, best / 1000);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+
+    sp<IJ007Engine> service = IJ007Engine::getService();
+    if (service == nullptr) {
+        printf("Failed to get J007Engine 1.1 service\n");
+        return -1;
+    }
+
+    char text[512];
+    hidl_string appStatus[2], batteryStatus[2], packageName("com.tencent.mm");
+    AppScene app[2];
+    BatteryScene battery[2];
+    for (int i = 0; i < 2; i++) {
+        snprintf(text, sizeof(text), SCENE_APP, SCENE_FPS[i]);
+        appStatus[i] = text;
+        snprintf(text, sizeof(text), SCENE_BATTERY, SCENE_LEVEL[i], SCENE_TEMPERATURE[i]);
+        batteryStatus[i] = text;
+
+        app[i].packageName = "com.tencent.mm";
+        app[i].type = "im";
+        app[i].mode = -1;
+        app[i].fps = SCENE_FPS[i];
+        app[i].cpu = -1;
+        app[i].memc = -1;
+
+        battery[i].level = SCENE_LEVEL[i];
+        battery[i].pluggedIn = 2;
+        battery[i].status = 2;
+        battery[i].health = 2;
+        battery[i].temperature = SCENE_TEMPERATURE[i];
+    }
+
+    bench("app/notifySceneChanged", sceneChangedBytes(appStatus[0], packageName), iterations, [&](int i) {
+        Return<bool> ret = service->notifySceneChanged(SCENE_FACTOR_APP, appStatus[i & 1], packageName);
+        return ret.isOk() && (bool) ret;
+    });
+
+    bench("app/notifyAppSwitch", appSwitchBytes(app[0]), iterations, [&](int i) {
+        Return<bool> ret = service->notifyAppSwitch(app[i & 1]);
+        return ret.isOk() && (bool) ret;
+    });
+
+    bench("battery/notifySceneChanged", sceneChangedBytes(batteryStatus[0], packageName), iterations, [&](int i) {
+        Return<bool> ret = service->notifySceneChanged(SCENE_FACTOR_BATTERY, batteryStatus[i & 1], packageName);
+        return ret.isOk() && (bool) ret;
+    });
+
+    bench("battery/notifyBattery", batteryBytes(battery[0]), iterations, [&](int i) {
+        Return<bool> ret = service->notifyBattery(battery[i & 1]);
+        return ret.isOk() && (bool) ret;
+    });
+
+    return 0;
+}
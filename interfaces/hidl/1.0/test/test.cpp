@@ -14,16 +14,57 @@
  * limitations under the License.
  */
 
-#include <com/journeyOS/J007engine/hidl/1.0/IJ007Engine.h>
+#include <com/journeyOS/J007engine/hidl/1.0/types.h>
+#include <com/journeyOS/J007engine/hidl/1.1/IJ007Engine.h>
 
 using ::android::sp;
 using ::android::hardware::Return;
 using ::android::hardware::Void;
 // Generated HIDL files
-using ::com::journeyOS::J007engine::hidl::V1_0::IJ007Engine;
+using ::com::journeyOS::J007engine::hidl::V1_1::IJ007Engine;
 using ::com::journeyOS::J007engine::hidl::V1_0::Status;
 using ::com::journeyOS::J007engine::hidl::V1_0::TCode;
 using ::com::journeyOS::J007engine::hidl::V1_0::J007EngineResponse;
+using ::com::journeyOS::J007engine::hidl::V1_1::SceneTransition;
+using ::com::journeyOS::J007engine::hidl::V1_1::AppScene;
+using ::android::hardware::hidl_vec;
+
+// the version of the last transition in the engine's history, 0 for none
+static uint64_t lastVersion(const sp<IJ007Engine> &service) {
+    uint64_t version = 0;
+    service->getSceneHistory(1, [&version](const hidl_vec<SceneTransition> &history) {
+        version = history.size() != 0 ? history[0].version : 0;
+    });
+    return version;
+}
+
+// Three app switches back to back, well inside the engine's coalescing window: the agents may
+// take them at once, the history must still have each of them
+static bool checkHistoryCoalesced(const sp<IJ007Engine> &service) {
+    static const int FPS[3] = {60, 90, 120};
+    uint64_t since = lastVersion(service);
+
+    AppScene app;
+    app.packageName = "com.journeyOS.J007engine.test";
+    app.type = "default";
+    app.mode = -1;
+    app.cpu = -1;
+    app.memc = -1;
+    for (int fps : FPS) {
+        app.fps = fps;
+        service->notifyAppSwitch(app);
+    }
+
+    int count = 0;
+    service->getSceneHistory(0, [since, &count](const hidl_vec<SceneTransition> &history) {
+        for (const SceneTransition &transition : history) {
+            count += transition.version > since;
+        }
+    });
+
+    printf("history of 3 updates in one window: %d transitions, %s\n", count, count == 3 ? "PASS" : "FAIL");
+    return count == 3;
+}
 
 int main() {
     sp<IJ007Engine> service = IJ007Engine::getService();
@@ -34,5 +75,17 @@ int main() {
 
     //service->getConfig(TCode::GET_XXX);
 
-    return 0;
+    bool passed = checkHistoryCoalesced(service);
+
+    //the scene transitions the engine went through, oldest first
+    service->getSceneHistory(0, [](const hidl_vec<SceneTransition> &history) {
+        for (const SceneTransition &transition : history) {
+            printf("%lld.%09lld version = %llu , factors = %d , packageName = %s , type = %s , policy = %s\n",
+                   (long long) (transition.timestamp / 1000000000), (long long) (transition.timestamp % 1000000000),
+                   (unsigned long long) transition.version, transition.factors, transition.packageName.c_str(),
+                   transition.appType.c_str(), transition.policy.c_str());
+        }
+    });
+
+    return passed ? 0 : -1;
 }